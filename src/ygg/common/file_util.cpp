@@ -49,4 +49,47 @@ namespace ygg::file_util
         }
         return s.substr(1, s.length());
     }
+
+    std::vector<uint8_t> file_to_bytes(const std::string& path)
+    {
+        std::ifstream input(path, std::ios::binary | std::ios::ate);
+        if (input.fail())
+        {
+            throw IO_error(std::string("Failed to open '") + path + "'.");
+        }
+        auto size = input.tellg();
+        std::vector<uint8_t> result(static_cast<std::size_t>(size));
+        input.seekg(0);
+        input.read(reinterpret_cast<char*>(result.data()), size);
+        if (input.fail())
+        {
+            throw IO_error(std::string("Failed to read '") + path + "'.");
+        }
+        return result;
+    }
+
+    void bytes_to_file_atomic(const std::string& path, std::span<const uint8_t> data)
+    {
+        std::string temp_path = path + ".tmp";
+        {
+            std::ofstream output(temp_path, std::ios::binary | std::ios::trunc);
+            if (output.fail())
+            {
+                throw IO_error(std::string("Failed to open '") + temp_path + "'.");
+            }
+            output.write(reinterpret_cast<const char*>(data.data()), std::streamsize(data.size()));
+            output.flush();
+            if (output.fail())
+            {
+                throw IO_error(std::string("Failed to write '") + temp_path + "'.");
+            }
+        }
+        std::error_code error = {};
+        std::filesystem::rename(temp_path, path, error);
+        if (error)
+        {
+            std::filesystem::remove(temp_path, error);
+            throw IO_error(std::string("Failed to replace '") + path + "'.");
+        }
+    }
 }
@@ -2,8 +2,11 @@
 
 #pragma once
 
+#include <cstdint>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace ygg::file_util
 {
@@ -18,4 +21,18 @@ namespace ygg::file_util
     std::string file_to_str(const std::string& path);
 
     std::string file_ext_to_str(const std::string& path);
+
+    /**
+     * @brief Reads the whole file as binary data.
+     * @throws IO_error if the file can't be opened or read.
+    */
+    std::vector<uint8_t> file_to_bytes(const std::string& path);
+
+    /**
+     * @brief Writes binary data to a file, replacing it atomically.
+     * @details The data is written to a temporary file next to `path` which is then renamed,
+     * so readers either see the old or the new file but never a partially written one.
+     * @throws IO_error if the file can't be written or replaced.
+    */
+    void bytes_to_file_atomic(const std::string& path, std::span<const uint8_t> data);
 }
@@ -0,0 +1,49 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace ygg::hash
+{
+    constexpr uint64_t FNV_1A_64_OFFSET_BASIS = 14695981039346656037ull;
+    constexpr uint64_t FNV_1A_64_PRIME = 1099511628211ull;
+
+    /**
+     * @brief Hashes the given bytes using 64 bit FNV-1a.
+     * @param seed The hash to continue from, used to hash multiple values into a single hash.
+    */
+    inline uint64_t fnv_1a_64(const void* data, std::size_t size, uint64_t seed = FNV_1A_64_OFFSET_BASIS)
+    {
+        auto bytes = static_cast<const uint8_t*>(data);
+        uint64_t result = seed;
+        for (std::size_t i = 0; i < size; i++) {
+            result ^= bytes[i];
+            result *= FNV_1A_64_PRIME;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Hashes the characters of the string. The length is hashed as well, so consecutive strings
+     * can't collide by moving characters between them.
+    */
+    inline uint64_t fnv_1a_64_str(std::string_view str, uint64_t seed = FNV_1A_64_OFFSET_BASIS)
+    {
+        std::size_t length = str.size();
+        return fnv_1a_64(str.data(), str.size(), fnv_1a_64(&length, sizeof(length), seed));
+    }
+
+    /**
+     * @brief Hashes the object representation of a trivially copyable value.
+    */
+    template<typename T>
+    requires std::is_trivially_copyable_v<T>
+    uint64_t fnv_1a_64_value(const T& value, uint64_t seed = FNV_1A_64_OFFSET_BASIS)
+    {
+        return fnv_1a_64(&value, sizeof(T), seed);
+    }
+}
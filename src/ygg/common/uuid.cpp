@@ -2,6 +2,7 @@
 
 #include "ygg/common/uuid.h"
 
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
 #include <rpc.h>
 
 namespace ygg
@@ -27,3 +28,43 @@ namespace ygg
         return result;
     }
 }
+#else
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+namespace ygg
+{
+    UUID create_uuid()
+    {
+        // Random (version 4) UUID, as there is no system service to ask for one.
+        thread_local std::mt19937_64 engine(std::random_device{}());
+        uint64_t high = engine();
+        uint64_t low = engine();
+        UUID result = {
+            .data1 = uint32_t(high >> 32),
+            .data2 = uint16_t(high >> 16),
+            .data3 = uint16_t((high & 0x0fffull) | 0x4000ull),
+            .data4 = 0
+        };
+        // data4 is stored as a byte array by the native implementation, the first byte holds the variant.
+        std::array<uint8_t, 8> data4 = {};
+        memcpy(data4.data(), &low, sizeof(low));
+        data4[0] = uint8_t((data4[0] & 0x3f) | 0x80);
+        memcpy(&result.data4, data4.data(), sizeof(result.data4));
+        return result;
+    }
+
+    std::string uuid_to_string(const UUID& uuid)
+    {
+        std::array<uint8_t, 8> data4 = {};
+        memcpy(data4.data(), &uuid.data4, sizeof(uuid.data4));
+        std::array<char, 37> buffer = {};
+        snprintf(buffer.data(), buffer.size(), "%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+            uuid.data1, uuid.data2, uuid.data3,
+            data4[0], data4[1], data4[2], data4[3], data4[4], data4[5], data4[6], data4[7]);
+        return std::string(buffer.data());
+    }
+}
+#endif
@@ -0,0 +1,67 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace ygg::memory
+{
+    /**
+     * @brief Allocates stable 32-bit slots out of a fixed capacity.
+     * @details Freed slots are kept in a free list and reused first. Slots that were never allocated are
+     * handed out in increasing order, which keeps the used range as small as possible.
+     * All functions must be externally synchronized.
+    */
+    class Slot_allocator
+    {
+    public:
+        constexpr static uint32_t INVALID_SLOT = ~0u;
+
+        explicit Slot_allocator(uint32_t capacity)
+            : m_capacity(capacity)
+        {}
+
+        /**
+         * @brief Allocates a slot.
+         * @return The slot or `INVALID_SLOT` if all slots are allocated.
+        */
+        [[nodiscard]] uint32_t allocate()
+        {
+            if (!m_free_slots.empty()) {
+                uint32_t slot = m_free_slots.back();
+                m_free_slots.pop_back();
+                return slot;
+            }
+            if (m_next_slot < m_capacity) {
+                return m_next_slot++;
+            }
+            return INVALID_SLOT;
+        }
+
+        /**
+         * @brief Returns a slot to the free list. The slot must be allocated.
+        */
+        void free(uint32_t slot)
+        {
+            assert(slot < m_next_slot && "Freeing a slot that was never allocated.");
+            m_free_slots.push_back(slot);
+        }
+
+        [[nodiscard]] uint32_t capacity() const noexcept { return m_capacity; }
+
+        /**
+         * @brief Returns the amount of currently allocated slots.
+        */
+        [[nodiscard]] uint32_t allocated_count() const noexcept
+        {
+            return m_next_slot - uint32_t(m_free_slots.size());
+        }
+
+    private:
+        uint32_t m_capacity;
+        uint32_t m_next_slot = 0;
+        std::vector<uint32_t> m_free_slots = {};
+    };
+}
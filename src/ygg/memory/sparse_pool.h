@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include <cstdint>
+#include <cstring>
 #include <type_traits>
 #include <vector>
 
@@ -17,7 +19,7 @@ namespace ygg::memory
         static_assert(sizeof(T) >= sizeof(std::size_t),
             "This implementation of Sparse_pool stores the linked list inside the data store itself. "
             "The index size (sizeof(std::size_t)) must be less than or equal to sizeof(T).");
-        static_assert(std::is_trivial(T)::value && std::is_standard_layout(T)::value,
+        static_assert(std::is_trivial<T>::value && std::is_standard_layout<T>::value,
             "T must be POD.");
     public:
         /**
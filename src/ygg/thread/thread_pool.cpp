@@ -0,0 +1,55 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/thread/thread_pool.h"
+
+#include <algorithm>
+
+namespace ygg::thread
+{
+    Thread_pool::Thread_pool(uint32_t thread_count)
+        : m_tasks(), m_threads()
+    {
+        if (thread_count == 0) {
+            thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        m_threads.reserve(thread_count);
+        for (uint32_t i = 0; i < thread_count; i++) {
+            m_threads.emplace_back(&Thread_pool::work, this);
+        }
+    }
+
+    Thread_pool::~Thread_pool()
+    {
+        // An empty task tells a worker to exit.
+        for (std::size_t i = 0; i < m_threads.size(); i++) {
+            m_tasks.enqueue(std::function<void()>());
+        }
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+        // The queue only orders tasks per producer, tasks pushed by other threads may be left behind.
+        std::function<void()> task;
+        while (m_tasks.try_dequeue(task)) {
+            if (task) {
+                task();
+            }
+        }
+    }
+
+    void Thread_pool::push(std::function<void()> task)
+    {
+        m_tasks.enqueue(std::move(task));
+    }
+
+    void Thread_pool::work()
+    {
+        while (true) {
+            std::function<void()> task;
+            m_tasks.wait_dequeue(task);
+            if (!task) {
+                return;
+            }
+            task();
+        }
+    }
+}
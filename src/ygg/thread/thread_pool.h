@@ -0,0 +1,62 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include <blockingconcurrentqueue.h>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ygg::thread
+{
+    /**
+     * @brief Fixed size pool of worker threads executing pushed tasks.
+     * @details Tasks are stored in a lock-free blocking queue, idle workers sleep until a task is pushed.
+     * Tasks pushed by the same thread start in push order, there is no order between different threads.
+     * Pending tasks are still executed on destruction.
+    */
+    class Thread_pool
+    {
+    public:
+        /**
+         * @brief Creates the pool and starts its workers.
+         * @param thread_count The amount of worker threads. If zero, one thread per hardware thread is used.
+        */
+        explicit Thread_pool(uint32_t thread_count = 0);
+        ~Thread_pool();
+
+        Thread_pool(const Thread_pool& other) = delete;
+        Thread_pool& operator=(const Thread_pool& other) = delete;
+
+        /**
+         * @brief Pushes a task to be executed by any worker. The task must not be empty.
+        */
+        void push(std::function<void()> task);
+
+        /**
+         * @brief Pushes a task and returns a future for its result.
+         * @details Exceptions thrown by the task are rethrown by `std::future::get`.
+        */
+        template<typename F>
+        std::future<std::invoke_result_t<F>> submit(F&& f)
+        {
+            // std::function requires a copyable target, so the move-only task is shared.
+            auto task = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::forward<F>(f));
+            auto future = task->get_future();
+            push([task]() { (*task)(); });
+            return future;
+        }
+
+        uint32_t thread_count() const { return uint32_t(m_threads.size()); }
+
+    private:
+        void work();
+
+    private:
+        moodycamel::BlockingConcurrentQueue<std::function<void()>> m_tasks;
+        std::vector<std::thread> m_threads;
+    };
+}
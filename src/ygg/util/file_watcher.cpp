@@ -0,0 +1,119 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/util/file_watcher.h"
+
+#include <cstdio>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace ygg::util
+{
+    std::string File_watcher::normalize_path(const std::string& path)
+    {
+        std::error_code error = {};
+        auto absolute = std::filesystem::absolute(path, error);
+        if (error) {
+            absolute = path;
+        }
+        return absolute.lexically_normal().generic_string();
+    }
+
+#if defined(__linux__)
+    File_watcher::File_watcher()
+        : m_inotify(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+    {
+        if (m_inotify < 0) {
+            printf("Failed to initialize inotify, file changes are not detected.\n"); // TODO: logging?
+        }
+    }
+
+    File_watcher::~File_watcher()
+    {
+        if (m_inotify >= 0) {
+            close(m_inotify);
+        }
+    }
+
+    void File_watcher::watch(const std::string& path)
+    {
+        auto file = normalize_path(path);
+        if (!m_files.insert(file).second || m_inotify < 0) {
+            return;
+        }
+        auto directory = std::filesystem::path(file).parent_path().generic_string();
+        if (m_watched_directories.contains(directory)) {
+            return;
+        }
+        // Editors often save by writing a new file and renaming it over the old one, so the directory
+        // is watched instead of the file itself.
+        int wd = inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd < 0) {
+            printf("Failed to watch directory '%s'.\n", directory.c_str()); // TODO: logging?
+            return;
+        }
+        m_directories[wd] = directory;
+        m_watched_directories.insert(directory);
+    }
+
+    std::vector<std::string> File_watcher::poll_changes()
+    {
+        std::unordered_set<std::string> changes = {};
+        if (m_inotify >= 0) {
+            alignas(inotify_event) char buffer[4096];
+            while (true) {
+                auto size = read(m_inotify, buffer, sizeof(buffer));
+                if (size <= 0) {
+                    break;
+                }
+                for (char* ptr = buffer; ptr < buffer + size;) {
+                    const auto* event = reinterpret_cast<const inotify_event*>(ptr);
+                    ptr += sizeof(inotify_event) + event->len;
+                    auto directory = m_directories.find(event->wd);
+                    if (event->len == 0 || directory == m_directories.end()) {
+                        continue;
+                    }
+                    auto file = directory->second + "/" + event->name;
+                    if (m_files.contains(file)) {
+                        changes.insert(std::move(file));
+                    }
+                }
+            }
+        }
+        return { changes.begin(), changes.end() };
+    }
+#else
+    File_watcher::File_watcher()
+    {}
+
+    File_watcher::~File_watcher()
+    {}
+
+    void File_watcher::watch(const std::string& path)
+    {
+        auto file = normalize_path(path);
+        if (!m_files.insert(file).second) {
+            return;
+        }
+        std::error_code error = {};
+        m_write_times[file] = std::filesystem::last_write_time(file, error);
+    }
+
+    std::vector<std::string> File_watcher::poll_changes()
+    {
+        std::vector<std::string> changes = {};
+        for (auto& [file, write_time] : m_write_times) {
+            std::error_code error = {};
+            auto current_write_time = std::filesystem::last_write_time(file, error);
+            // Files that are being replaced may not exist for a moment, they are picked up on a later poll.
+            if (!error && current_write_time != write_time) {
+                write_time = current_write_time;
+                changes.push_back(file);
+            }
+        }
+        return changes;
+    }
+#endif
+}
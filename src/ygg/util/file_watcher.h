@@ -0,0 +1,55 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ygg::util
+{
+    /**
+     * @brief Watches files for modifications without blocking.
+     * @details On Linux the parent directories of the watched files are watched with inotify, so files replaced
+     * by editors saving through a rename are still detected. Other platforms compare the last write time of
+     * every watched file on each poll.
+     * All paths are normalized with `normalize_path`, so different spellings of the same file compare equal.
+     * All functions must be externally synchronized.
+    */
+    class File_watcher
+    {
+    public:
+        File_watcher();
+        ~File_watcher();
+
+        File_watcher(const File_watcher& other) = delete;
+        File_watcher& operator=(const File_watcher& other) = delete;
+
+        /**
+         * @brief Adds a file to the watched files. Watching a file twice has no effect.
+        */
+        void watch(const std::string& path);
+
+        /**
+         * @brief Returns every watched file that was modified since the last poll, each at most once.
+        */
+        std::vector<std::string> poll_changes();
+
+        /**
+         * @brief Returns the absolute, lexically normal form of the path with `/` separators.
+        */
+        static std::string normalize_path(const std::string& path);
+
+    private:
+        std::unordered_set<std::string> m_files = {};
+#if defined(__linux__)
+        int m_inotify = -1;
+        std::unordered_map<int, std::string> m_directories = {};
+        std::unordered_set<std::string> m_watched_directories = {};
+#else
+        std::unordered_map<std::string, std::filesystem::file_time_type> m_write_times = {};
+#endif
+    };
+}
@@ -0,0 +1,223 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/vulkan/bindless_descriptor_heap.h"
+
+#include "ygg/vulkan/resource.h"
+
+#include <cassert>
+#include <cstdio>
+#include <volk.h>
+
+namespace ygg::vk
+{
+    constexpr static std::array<VkDescriptorType, BINDLESS_RESOURCE_TYPE_COUNT> BINDLESS_DESCRIPTOR_TYPES = {
+        VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+        VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        VK_DESCRIPTOR_TYPE_SAMPLER
+    };
+
+    Bindless_descriptor_heap::Bindless_descriptor_heap(VkDevice device, Layout_cache& layout_cache,
+        const Bindless_descriptor_heap_info& info)
+        : m_device(device), m_layout_cache(layout_cache),
+        m_write_batcher(device)
+    {
+        std::array<uint32_t, BINDLESS_RESOURCE_TYPE_COUNT> capacities = {
+            info.max_sampled_images,
+            info.max_storage_images,
+            info.max_storage_buffers,
+            info.max_samplers
+        };
+
+        std::array<VkDescriptorPoolSize, BINDLESS_RESOURCE_TYPE_COUNT> pool_sizes = {};
+        for (uint32_t i = 0; i < BINDLESS_RESOURCE_TYPE_COUNT; i++) {
+            m_slot_allocators.emplace_back(capacities[i]);
+            pool_sizes[i] = {
+                .type = BINDLESS_DESCRIPTOR_TYPES[i],
+                .descriptorCount = capacities[i]
+            };
+            m_set_layouts[i] = m_layout_cache.acquire_descriptor_set_layout({
+                .flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+                .bindings = {
+                    {
+                        .binding = 0,
+                        .type = BINDLESS_DESCRIPTOR_TYPES[i],
+                        .count = capacities[i],
+                        .stages = VK_SHADER_STAGE_ALL,
+                        .immutable_samplers = {},
+                        .flags = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                            VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                            VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT
+                    }
+                }
+                });
+        }
+
+        VkDescriptorPoolCreateInfo pool_info = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+            .maxSets = BINDLESS_RESOURCE_TYPE_COUNT,
+            .poolSizeCount = uint32_t(pool_sizes.size()),
+            .pPoolSizes = pool_sizes.data()
+        };
+        // TODO: VK_CHECK
+        vkCreateDescriptorPool(m_device, &pool_info, nullptr, &m_pool);
+
+        VkDescriptorSetVariableDescriptorCountAllocateInfo variable_count_info = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .descriptorSetCount = uint32_t(capacities.size()),
+            .pDescriptorCounts = capacities.data()
+        };
+        VkDescriptorSetAllocateInfo alloc_info = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .pNext = &variable_count_info,
+            .descriptorPool = m_pool,
+            .descriptorSetCount = uint32_t(m_set_layouts.size()),
+            .pSetLayouts = m_set_layouts.data()
+        };
+        // TODO: VK_CHECK
+        vkAllocateDescriptorSets(m_device, &alloc_info, m_sets.data());
+    }
+
+    Bindless_descriptor_heap::~Bindless_descriptor_heap()
+    {
+        vkDestroyDescriptorPool(m_device, m_pool, nullptr);
+        for (auto layout : m_set_layouts) {
+            if (m_layout_cache.release_descriptor_set_layout(layout)) {
+                vkDestroyDescriptorSetLayout(m_device, layout, nullptr);
+            }
+        }
+    }
+
+    uint32_t Bindless_descriptor_heap::register_sampled_image(VkImageView view, VkImageLayout layout)
+    {
+        uint32_t index = allocate_slot(Bindless_resource_type::Sampled_image);
+        if (index != INVALID_BINDLESS_INDEX) {
+            Descriptor_image_info image_info = {
+                .sampler = VK_NULL_HANDLE,
+                .view = view,
+                .layout = layout
+            };
+            m_write_batcher.push({
+                .set = set(Bindless_resource_type::Sampled_image),
+                .binding = 0,
+                .array_index = index,
+                .type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                .image_infos = { &image_info, 1 }
+                });
+        }
+        return index;
+    }
+
+    uint32_t Bindless_descriptor_heap::register_storage_image(VkImageView view)
+    {
+        uint32_t index = allocate_slot(Bindless_resource_type::Storage_image);
+        if (index != INVALID_BINDLESS_INDEX) {
+            Descriptor_image_info image_info = {
+                .sampler = VK_NULL_HANDLE,
+                .view = view,
+                .layout = VK_IMAGE_LAYOUT_GENERAL
+            };
+            m_write_batcher.push({
+                .set = set(Bindless_resource_type::Storage_image),
+                .binding = 0,
+                .array_index = index,
+                .type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                .image_infos = { &image_info, 1 }
+                });
+        }
+        return index;
+    }
+
+    uint32_t Bindless_descriptor_heap::register_storage_buffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+    {
+        uint32_t index = allocate_slot(Bindless_resource_type::Storage_buffer);
+        if (index != INVALID_BINDLESS_INDEX) {
+            Descriptor_buffer_info buffer_info = {
+                .buffer = buffer,
+                .offset = offset,
+                .range = range
+            };
+            m_write_batcher.push({
+                .set = set(Bindless_resource_type::Storage_buffer),
+                .binding = 0,
+                .array_index = index,
+                .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .buffer_infos = { &buffer_info, 1 }
+                });
+        }
+        return index;
+    }
+
+    uint32_t Bindless_descriptor_heap::register_sampler(VkSampler sampler)
+    {
+        uint32_t index = allocate_slot(Bindless_resource_type::Sampler);
+        if (index != INVALID_BINDLESS_INDEX) {
+            Descriptor_image_info image_info = {
+                .sampler = sampler,
+                .view = VK_NULL_HANDLE,
+                .layout = VK_IMAGE_LAYOUT_UNDEFINED
+            };
+            m_write_batcher.push({
+                .set = set(Bindless_resource_type::Sampler),
+                .binding = 0,
+                .array_index = index,
+                .type = VK_DESCRIPTOR_TYPE_SAMPLER,
+                .image_infos = { &image_info, 1 }
+                });
+        }
+        return index;
+    }
+
+    void Bindless_descriptor_heap::release(Bindless_resource_type type, uint32_t index, uint64_t value)
+    {
+        if (index == INVALID_BINDLESS_INDEX) {
+            return;
+        }
+        assert((m_pending_releases.empty() || m_pending_releases.back().value <= value)
+            && "Bindless indices must be released in non-decreasing value order.");
+        m_pending_releases.emplace_back(Pending_release{
+            .value = value,
+            .type = type,
+            .index = index
+            });
+    }
+
+    void Bindless_descriptor_heap::collect(uint64_t completed_value)
+    {
+        std::size_t count = 0;
+        while (count < m_pending_releases.size() && m_pending_releases[count].value <= completed_value) {
+            const auto& release = m_pending_releases[count];
+            m_slot_allocators[uint32_t(release.type)].free(release.index);
+            count++;
+        }
+        m_pending_releases.erase(m_pending_releases.begin(), m_pending_releases.begin() + count);
+    }
+
+    void Bindless_descriptor_heap::flush_writes()
+    {
+        m_write_batcher.flush();
+    }
+
+    uint32_t Bindless_descriptor_heap::capacity(Bindless_resource_type type) const
+    {
+        return m_slot_allocators[uint32_t(type)].capacity();
+    }
+
+    uint32_t Bindless_descriptor_heap::allocated_count(Bindless_resource_type type) const
+    {
+        return m_slot_allocators[uint32_t(type)].allocated_count();
+    }
+
+    uint32_t Bindless_descriptor_heap::allocate_slot(Bindless_resource_type type)
+    {
+        uint32_t index = m_slot_allocators[uint32_t(type)].allocate();
+        if (index == memory::Slot_allocator::INVALID_SLOT) {
+            printf("Bindless descriptor heap is full.\n"); // TODO: logging?
+            return INVALID_BINDLESS_INDEX;
+        }
+        return index;
+    }
+}
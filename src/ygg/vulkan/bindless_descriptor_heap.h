@@ -0,0 +1,140 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include "ygg/memory/slot_allocator.h"
+#include "ygg/vulkan/descriptors.h"
+#include "ygg/vulkan/layout_cache.h"
+#include "ygg/vulkan/vk_forward_decl.h"
+
+#include <array>
+#include <vector>
+
+namespace ygg::vk
+{
+    /**
+     * @brief The resource types of the bindless descriptor heap.
+     * @details Every type lives in its own set at binding 0, the set index matches the enum value.
+    */
+    enum class Bindless_resource_type : uint32_t
+    {
+        Sampled_image = 0,
+        Storage_image,
+        Storage_buffer,
+        Sampler
+    };
+
+    constexpr static uint32_t BINDLESS_RESOURCE_TYPE_COUNT = 4;
+
+    /**
+     * @brief The amount of descriptors per resource type.
+     * @details Must not exceed the update-after-bind limits of the device.
+    */
+    struct Bindless_descriptor_heap_info
+    {
+        uint32_t max_sampled_images = 65536;
+        uint32_t max_storage_images = 8192;
+        uint32_t max_storage_buffers = 65536;
+        uint32_t max_samplers = 1024;
+    };
+
+    /**
+     * @brief Global descriptor table which shaders index with stable 32-bit indices.
+     * @details Every resource type is a single update-after-bind, partially bound descriptor set with a variable
+     * descriptor count. Indices are allocated from a free list, released indices are only reused once the
+     * given timeline value is reached, so the GPU can never observe a slot being overwritten while it is in use.
+     * Registrations are batched and must be applied with `flush_writes` before the next submit, updating the
+     * sets while they are bound is allowed.
+     * The set layouts are acquired from the layout cache, so they can be used in pipeline layouts of it.
+     * All functions must be externally synchronized.
+    */
+    class Bindless_descriptor_heap
+    {
+    public:
+        /**
+         * @param layout_cache Must outlive the heap.
+        */
+        Bindless_descriptor_heap(VkDevice device, Layout_cache& layout_cache,
+            const Bindless_descriptor_heap_info& info = {});
+        ~Bindless_descriptor_heap();
+
+        Bindless_descriptor_heap(const Bindless_descriptor_heap& other) = delete;
+        Bindless_descriptor_heap& operator=(const Bindless_descriptor_heap& other) = delete;
+
+        /**
+         * @brief Writes the sampled image into a free slot and returns its index.
+         * @details If all sampled image slots are used, `INVALID_BINDLESS_INDEX` is returned.
+        */
+        uint32_t register_sampled_image(VkImageView view, VkImageLayout layout);
+
+        /**
+         * @brief Writes the storage image into a free slot and returns its index.
+         * @details If all storage image slots are used, `INVALID_BINDLESS_INDEX` is returned.
+        */
+        uint32_t register_storage_image(VkImageView view);
+
+        /**
+         * @brief Writes the buffer range into a free storage buffer slot and returns its index.
+         * @details If all storage buffer slots are used, `INVALID_BINDLESS_INDEX` is returned.
+        */
+        uint32_t register_storage_buffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
+
+        /**
+         * @brief Writes the sampler into a free slot and returns its index.
+         * @details If all sampler slots are used, `INVALID_BINDLESS_INDEX` is returned.
+        */
+        uint32_t register_sampler(VkSampler sampler);
+
+        /**
+         * @brief Frees the slot once `collect` is called with a value greater than or equal to `value`.
+         * @details Values must be passed in non-decreasing order.
+        */
+        void release(Bindless_resource_type type, uint32_t index, uint64_t value);
+
+        /**
+         * @brief Frees all slots released with a value less than or equal to `completed_value`.
+        */
+        void collect(uint64_t completed_value);
+
+        /**
+         * @brief Applies all pending registrations.
+        */
+        void flush_writes();
+
+        VkDescriptorSetLayout set_layout(Bindless_resource_type type) const { return m_set_layouts[uint32_t(type)]; }
+        VkDescriptorSet set(Bindless_resource_type type) const { return m_sets[uint32_t(type)]; }
+
+        /**
+         * @brief Returns all set layouts ordered by their set index.
+        */
+        const std::array<VkDescriptorSetLayout, BINDLESS_RESOURCE_TYPE_COUNT>& set_layouts() const { return m_set_layouts; }
+
+        /**
+         * @brief Returns all sets ordered by their set index, to be bound with a single call.
+        */
+        const std::array<VkDescriptorSet, BINDLESS_RESOURCE_TYPE_COUNT>& sets() const { return m_sets; }
+
+        uint32_t capacity(Bindless_resource_type type) const;
+        uint32_t allocated_count(Bindless_resource_type type) const;
+
+    private:
+        uint32_t allocate_slot(Bindless_resource_type type);
+
+    private:
+        struct Pending_release
+        {
+            uint64_t value;
+            Bindless_resource_type type;
+            uint32_t index;
+        };
+
+        VkDevice m_device;
+        Layout_cache& m_layout_cache;
+        VkDescriptorPool m_pool = nullptr;
+        std::array<VkDescriptorSetLayout, BINDLESS_RESOURCE_TYPE_COUNT> m_set_layouts = {};
+        std::array<VkDescriptorSet, BINDLESS_RESOURCE_TYPE_COUNT> m_sets = {};
+        std::vector<memory::Slot_allocator> m_slot_allocators = {};
+        std::vector<Pending_release> m_pending_releases = {};
+        Descriptor_write_batcher m_write_batcher;
+    };
+}
@@ -5,6 +5,8 @@
 #include "ygg/vulkan/image_utils.h"
 #include "ygg/vulkan/resource.h"
 
+#include <array>
+#include <cassert>
 #include <volk.h>
 
 namespace ygg::vk
@@ -21,6 +23,24 @@ namespace ygg::vk
         vkCmdBindDescriptorSets(m_cmdbuf, bind_point, layout, first_set, uint32_t(sets.size()), sets.data(), 0, nullptr);
     }
 
+    void Compute_command_buffer::bind_descriptor_buffer(VkDeviceAddress address, VkBufferUsage usage) const
+    {
+        VkDescriptorBufferBindingInfoEXT binding_info = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT,
+            .pNext = nullptr,
+            .address = address,
+            .usage = usage
+        };
+        vkCmdBindDescriptorBuffersEXT(m_cmdbuf, 1, &binding_info);
+    }
+
+    void Compute_command_buffer::set_descriptor_buffer_offset(VkPipelineBindPoint bind_point,
+        VkPipelineLayout layout, uint32_t set_offset, VkDeviceSize offset) const
+    {
+        uint32_t buffer_index = 0;
+        vkCmdSetDescriptorBufferOffsetsEXT(m_cmdbuf, bind_point, layout, set_offset, 1, &buffer_index, &offset);
+    }
+
     void Compute_command_buffer::bind_pipeline(const Pipeline& pipeline) const
     {
         vkCmdBindPipeline(m_cmdbuf, pipeline.bind_point, pipeline.handle);
@@ -69,6 +89,37 @@ namespace ygg::vk
         vkCmdDispatchIndirect(m_cmdbuf, select_allocated_buffer(buffer, m_frame_in_flight).handle, buffer_offset);
     }
 
+    // Every device supports at least 32 push descriptors and every write contains at least one,
+    // larger pushes are split into multiple commands updating the same set.
+    constexpr static uint32_t MAX_PUSH_DESCRIPTOR_WRITES = 32;
+
+    void Compute_command_buffer::push_descriptor_set(VkPipelineBindPoint bind_point,
+        VkPipelineLayout layout, uint32_t set_offset, const Descriptor_set_write_info& write_info) const
+    {
+        push_descriptor_set(bind_point, layout, set_offset, { &write_info, 1 });
+    }
+
+    void Compute_command_buffer::push_descriptor_set(VkPipelineBindPoint bind_point,
+        VkPipelineLayout layout, uint32_t set_offset, std::span<const Descriptor_set_write_info> write_infos) const
+    {
+        std::array<VkWriteDescriptorSet, MAX_PUSH_DESCRIPTOR_WRITES> writes;
+        uint32_t write_count = 0;
+        for (const auto& write_info : write_infos) {
+            translate_descriptor_set_write(write_info, writes[write_count]);
+            if (writes[write_count].descriptorCount == 0) {
+                continue;
+            }
+            writes[write_count].dstSet = VK_NULL_HANDLE;
+            if (++write_count == writes.size()) {
+                vkCmdPushDescriptorSetKHR(m_cmdbuf, bind_point, layout, set_offset, write_count, writes.data());
+                write_count = 0;
+            }
+        }
+        if (write_count > 0) {
+            vkCmdPushDescriptorSetKHR(m_cmdbuf, bind_point, layout, set_offset, write_count, writes.data());
+        }
+    }
+
     void Compute_command_buffer::push_constants(VkPipelineLayout layout,
         VkShaderStageFlags stages, const void* data, uint32_t size, uint32_t offset) const
     {
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "ygg/vulkan/descriptors.h"
 #include "ygg/vulkan/transfer_command_buffer.h"
 
 #include <span>
@@ -44,6 +45,19 @@ namespace ygg::vk
         void bind_descriptor_sets(VkPipelineBindPoint bind_point, VkPipelineLayout layout,
             uint32_t first_set, const std::span<VkDescriptorSet>& sets) const;
 
+        /**
+         * @brief https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/vkCmdBindDescriptorBuffersEXT.html
+         * @details Binds a single descriptor buffer at index 0, replacing any previously bound descriptor buffers.
+        */
+        void bind_descriptor_buffer(VkDeviceAddress address, VkBufferUsage usage) const;
+
+        /**
+         * @brief https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/vkCmdSetDescriptorBufferOffsetsEXT.html
+         * @details Points the set at the given offset into the descriptor buffer bound at index 0.
+        */
+        void set_descriptor_buffer_offset(VkPipelineBindPoint bind_point, VkPipelineLayout layout,
+            uint32_t set_offset, VkDeviceSize offset) const;
+
         /**
          * @brief https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/vkCmdBindPipeline.html
         */
@@ -71,6 +85,17 @@ namespace ygg::vk
         */
         void dispatch_indirect(const Buffer& buffer, uint32_t buffer_offset) const;
 
+        /**
+         * @brief https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/vkCmdPushDescriptorSetKHR.html
+         * @details Records the descriptors of a push layout into the command buffer, no set has to be allocated,
+         * updated or bound. The `set` member of the write infos is ignored. Requires VK_KHR_push_descriptor,
+         * see `Context::is_push_descriptor_supported`.
+        */
+        void push_descriptor_set(VkPipelineBindPoint bind_point, VkPipelineLayout layout,
+            uint32_t set_offset, const Descriptor_set_write_info& write_info) const;
+        void push_descriptor_set(VkPipelineBindPoint bind_point, VkPipelineLayout layout,
+            uint32_t set_offset, std::span<const Descriptor_set_write_info> write_infos) const;
+
         /**
          * @brief https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/vkCmdPushConstants.html
         */
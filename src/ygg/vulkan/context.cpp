@@ -5,6 +5,10 @@
 #include "ygg/vulkan/graphics_command_buffer.h"
 #include "ygg/vulkan/window_system_integration.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
 #define VOLK_IMPLEMENTATION
 #include <volk.h>
 
@@ -16,13 +20,14 @@
 
 namespace ygg::vk
 {
-    Frame_context::Frame_context(const Context& context)
+    Frame_context::Frame_context(Context& context)
         : m_context(context),
         m_linear_host_resource_allocator_provider(m_context.allocator()),
         m_graphics_command_buffer_recycler(m_context.device(), m_context.graphics_queue().queue_family_index,
             VK_COMMAND_POOL_CREATE_TRANSIENT_BIT),
-        m_async_compute_command_buffer_recycler(m_context.device(), m_context.graphics_queue().queue_family_index,
-            VK_COMMAND_POOL_CREATE_TRANSIENT_BIT)
+        m_async_compute_command_buffer_recycler(m_context.device(), m_context.compute_queue().queue_family_index,
+            VK_COMMAND_POOL_CREATE_TRANSIENT_BIT),
+        m_descriptor_write_batcher(m_context.device())
     {
         std::vector<Descriptor_pool_size> transient_pool_sizes = {
             { VK_DESCRIPTOR_TYPE_SAMPLER, 64 },
@@ -41,6 +46,10 @@ namespace ygg::vk
         m_transient_descriptor_set_allocator = std::make_unique<Transient_descriptor_set_allocator>(
             m_context.device(),
             transient_pool_sizes);
+        if (const auto* properties = m_context.descriptor_buffer_properties(); properties != nullptr) {
+            m_transient_descriptor_buffer = std::make_unique<Transient_descriptor_buffer>(m_context,
+                *properties, m_context.transient_descriptor_buffer_size());
+        }
     }
 
     Frame_context::~Frame_context()
@@ -50,23 +59,29 @@ namespace ygg::vk
 
     void Frame_context::start_frame()
     {
-        destroy_all_zombies();
         m_linear_host_resource_allocator_provider.reset();
         m_graphics_command_buffer_recycler.reset();
         m_async_compute_command_buffer_recycler.reset();
         m_transient_descriptor_set_allocator->reset();
+        if (m_transient_descriptor_buffer) {
+            m_transient_descriptor_buffer->reset();
+        }
+        m_descriptor_buffer_command_buffers.clear();
+        m_descriptor_write_batcher.reset_statistics();
     }
 
-    Linear_host_resource_allocator& Frame_context::acquire_linear_host_resource_allocator()
+    Linear_host_resource_allocator& Frame_context::acquire_linear_host_resource_allocator(uint32_t queue_family_index)
     {
-        return m_linear_host_resource_allocator_provider.create_allocator();
+        return m_linear_host_resource_allocator_provider.create_allocator(queue_family_index);
     }
 
     Compute_command_buffer Frame_context::acquire_async_compute_command_buffer()
     {
-        auto cmdbuf = m_graphics_command_buffer_recycler.get_or_allocate();
-        m_graphics_command_buffer_recycler.recycle(cmdbuf);
-        return Compute_command_buffer(cmdbuf, acquire_linear_host_resource_allocator(), m_context.current_frame_in_flight(),
+        auto cmdbuf = m_async_compute_command_buffer_recycler.get_or_allocate();
+        m_async_compute_command_buffer_recycler.recycle(cmdbuf);
+        return Compute_command_buffer(cmdbuf,
+            acquire_linear_host_resource_allocator(m_context.compute_queue().queue_family_index),
+            m_context.current_frame_in_flight(),
             m_context.compute_queue().queue_family_index);
     }
 
@@ -74,7 +89,9 @@ namespace ygg::vk
     {
         auto cmdbuf = m_graphics_command_buffer_recycler.get_or_allocate();
         m_graphics_command_buffer_recycler.recycle(cmdbuf);
-        return Graphics_command_buffer(cmdbuf, acquire_linear_host_resource_allocator(), m_context.current_frame_in_flight(),
+        return Graphics_command_buffer(cmdbuf,
+            acquire_linear_host_resource_allocator(m_context.graphics_queue().queue_family_index),
+            m_context.current_frame_in_flight(),
             m_context.graphics_queue().queue_family_index );
     }
 
@@ -83,20 +100,96 @@ namespace ygg::vk
         return m_transient_descriptor_set_allocator->get_set(layout);
     }
 
-    void Frame_context::destroy_all_zombies()
+    Transient_descriptors Frame_context::allocate_transient_descriptors(VkDescriptorSetLayout layout)
     {
-        for (auto z : m_zombie_semaphores) {
-            vkDestroySemaphore(m_context.device(), z, nullptr);
+        if (m_transient_descriptor_buffer && (m_context.layout_cache().descriptor_set_layout_info(layout).flags &
+            VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT)) {
+            return {
+                .set = VK_NULL_HANDLE,
+                .buffer_allocation = m_transient_descriptor_buffer->allocate(layout)
+            };
         }
-        m_zombie_semaphores.clear();
-        for (auto z : m_zombie_fences) {
-            vkDestroyFence(m_context.device(), z, nullptr);
+        return {
+            .set = m_transient_descriptor_set_allocator->get_set(layout),
+            .buffer_allocation = {}
+        };
+    }
+
+    void Frame_context::write_transient_descriptors(const Transient_descriptors& descriptors,
+        std::span<const Descriptor_set_write_info> write_infos)
+    {
+        if (descriptors.set == VK_NULL_HANDLE) {
+            m_transient_descriptor_buffer->write(descriptors.buffer_allocation, write_infos);
+            return;
+        }
+        for (auto write_info : write_infos) {
+            write_info.set = descriptors.set;
+            m_descriptor_write_batcher.push(write_info);
         }
-        m_zombie_fences.clear();
     }
 
-    Context::Context(const Window_system_integration& wsi)
-        : m_wsi(wsi)
+    void Frame_context::bind_transient_descriptors(const Compute_command_buffer& cmdbuf,
+        VkPipelineBindPoint bind_point, VkPipelineLayout layout, uint32_t set_offset,
+        const Transient_descriptors& descriptors)
+    {
+        if (descriptors.set == VK_NULL_HANDLE) {
+            // Binding descriptor buffers invalidates the offsets that are already set, so it's done only once.
+            auto& bound = m_descriptor_buffer_command_buffers;
+            if (std::find(bound.begin(), bound.end(), cmdbuf.handle()) == bound.end()) {
+                cmdbuf.bind_descriptor_buffer(m_transient_descriptor_buffer->device_address(),
+                    m_transient_descriptor_buffer->usage());
+                bound.push_back(cmdbuf.handle());
+            }
+            cmdbuf.set_descriptor_buffer_offset(bind_point, layout, set_offset,
+                descriptors.buffer_allocation.offset);
+            return;
+        }
+        // Sets must not be updated once bound, so all pending writes have to be applied first.
+        m_descriptor_write_batcher.flush();
+        cmdbuf.bind_descriptor_set(bind_point, layout, set_offset, descriptors.set);
+    }
+
+    void Frame_context::zombify_semaphore(VkSemaphore semaphore)
+    {
+        m_context.zombify_semaphore(semaphore);
+    }
+
+    void Frame_context::zombify_fence(VkFence fence)
+    {
+        m_context.zombify_fence(fence);
+    }
+
+    Bindless_descriptor_heap_info clamp_bindless_descriptor_heap_info(VkPhysicalDevice physical_device,
+        const Bindless_descriptor_heap_info& info)
+    {
+        VkPhysicalDeviceVulkan12Properties vulkan_12_properties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES,
+            .pNext = nullptr
+        };
+        VkPhysicalDeviceProperties2 properties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+            .pNext = &vulkan_12_properties
+        };
+        vkGetPhysicalDeviceProperties2(physical_device, &properties);
+        // The sets are visible to all stages, so the per-stage limits apply as well.
+        const auto& p = vulkan_12_properties;
+        return {
+            .max_sampled_images = std::min({ info.max_sampled_images,
+                p.maxDescriptorSetUpdateAfterBindSampledImages, p.maxPerStageDescriptorUpdateAfterBindSampledImages }),
+            .max_storage_images = std::min({ info.max_storage_images,
+                p.maxDescriptorSetUpdateAfterBindStorageImages, p.maxPerStageDescriptorUpdateAfterBindStorageImages }),
+            .max_storage_buffers = std::min({ info.max_storage_buffers,
+                p.maxDescriptorSetUpdateAfterBindStorageBuffers, p.maxPerStageDescriptorUpdateAfterBindStorageBuffers }),
+            .max_samplers = std::min({ info.max_samplers,
+                p.maxDescriptorSetUpdateAfterBindSamplers, p.maxPerStageDescriptorUpdateAfterBindSamplers })
+        };
+    }
+
+    Context::Context(const Window_system_integration& wsi, const Context_info& info)
+        : m_wsi(wsi),
+        m_max_frames_in_flight(std::clamp(info.max_frames_in_flight, 1u, uint32_t(YGG_MAX_FRAMES_IN_FLIGHT))),
+        m_low_latency(info.low_latency),
+        m_transient_descriptor_buffer_size(info.transient_descriptor_buffer_size)
     {
         if (volkInitialize() != VK_SUCCESS) {
             printf("Volk could not be initialized!"); // TODO: logging?
@@ -230,7 +323,9 @@ namespace ygg::vk
                 graphics_queue_found = true;
                 m_graphics_queue.queue_family_index = i;
                 queue_create_infos.push_back(queue_create_info);
-                vkGetPhysicalDeviceSurfaceSupportKHR(m_physical_device, i, m_surface, &main_queue_supports_present);
+                if (m_surface != VK_NULL_HANDLE) {
+                    vkGetPhysicalDeviceSurfaceSupportKHR(m_physical_device, i, m_surface, &main_queue_supports_present);
+                }
             }
             else if (queue_family_supports_compute(queue_family_properties[i]) &&
                 queue_family_supports_transfer(queue_family_properties[i]) &&
@@ -258,6 +353,91 @@ namespace ygg::vk
             extensions.push_back(ext.c_str());
         }
 
+        uint32_t device_extension_count = 0;
+        vkEnumerateDeviceExtensionProperties(m_physical_device, nullptr, &device_extension_count, nullptr);
+        std::vector<VkExtensionProperties> device_extensions(device_extension_count);
+        vkEnumerateDeviceExtensionProperties(m_physical_device, nullptr, &device_extension_count,
+            device_extensions.data());
+        auto device_extension_supported = [&device_extensions](const char* name) -> bool {
+            return std::any_of(device_extensions.begin(), device_extensions.end(),
+                [name](const VkExtensionProperties& properties) {
+                    return strcmp(properties.extensionName, name) == 0;
+                });
+        };
+
+        // Optional feature structs are chained in front of each other and appended to the device create info.
+        void* optional_features = nullptr;
+
+        // Graphics pipeline libraries are only worth it if linking is fast, otherwise pipelines are compiled whole.
+        VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphics_pipeline_library_features = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT,
+            .pNext = nullptr,
+            .graphicsPipelineLibrary = VK_FALSE
+        };
+        bool graphics_pipeline_library_supported = false;
+        if (info.graphics_pipeline_library &&
+            device_extension_supported(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME)) {
+            VkPhysicalDeviceFeatures2 features = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                .pNext = &graphics_pipeline_library_features
+            };
+            vkGetPhysicalDeviceFeatures2(m_physical_device, &features);
+            VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT graphics_pipeline_library_properties = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT,
+                .pNext = nullptr
+            };
+            VkPhysicalDeviceProperties2 properties = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+                .pNext = &graphics_pipeline_library_properties
+            };
+            vkGetPhysicalDeviceProperties2(m_physical_device, &properties);
+            graphics_pipeline_library_supported = graphics_pipeline_library_features.graphicsPipelineLibrary &&
+                graphics_pipeline_library_properties.graphicsPipelineLibraryFastLinking;
+        }
+        if (graphics_pipeline_library_supported) {
+            extensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+            extensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+            graphics_pipeline_library_features.pNext = optional_features;
+            optional_features = &graphics_pipeline_library_features;
+        }
+
+        // Descriptor buffers address the written resources and the buffer itself by device address.
+        VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptor_buffer_features = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT,
+            .pNext = nullptr,
+            .descriptorBuffer = VK_FALSE
+        };
+        bool descriptor_buffer_supported = false;
+        if (info.descriptor_buffer && device_extension_supported(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME)) {
+            VkPhysicalDeviceVulkan12Features supported_vulkan_12_features = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+                .pNext = &descriptor_buffer_features
+            };
+            VkPhysicalDeviceFeatures2 features = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                .pNext = &supported_vulkan_12_features
+            };
+            vkGetPhysicalDeviceFeatures2(m_physical_device, &features);
+            descriptor_buffer_supported = descriptor_buffer_features.descriptorBuffer &&
+                supported_vulkan_12_features.bufferDeviceAddress;
+            descriptor_buffer_features = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT,
+                .pNext = nullptr,
+                .descriptorBuffer = VK_TRUE
+            };
+        }
+        if (descriptor_buffer_supported) {
+            extensions.push_back(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+            descriptor_buffer_features.pNext = optional_features;
+            optional_features = &descriptor_buffer_features;
+        }
+
+        // Push descriptors are not part of any profile, so they are enabled whenever they are available.
+        m_push_descriptor_supported = device_extension_supported(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+        if (m_push_descriptor_supported) {
+            extensions.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+        }
+
         VkBool32 tier_1_device_supported = false;
         vpGetPhysicalDeviceProfileSupport(m_instance, m_physical_device, &tier_1_profile_props, &tier_1_device_supported);
         VkBool32 tier_2_device_supported = false;
@@ -267,7 +447,7 @@ namespace ygg::vk
 
         VkDeviceCreateInfo device_create_info = {
             .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-            .pNext = nullptr,
+            .pNext = optional_features,
             .flags = 0,
             .queueCreateInfoCount = uint32_t(queue_create_infos.size()),
             .pQueueCreateInfos = queue_create_infos.data(),
@@ -296,8 +476,59 @@ namespace ygg::vk
             m_profile = Profile::Tier_3;
         }
 
+        // Devices that don't support any of the profiles (e.g. software implementations) still
+        // have to provide the core Vulkan 1.3 features the engine relies on.
+        VkPhysicalDeviceVulkan12Features fallback_vulkan_12_features = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+            .pNext = nullptr,
+            .timelineSemaphore = VK_TRUE
+        };
+        VkPhysicalDeviceVulkan13Features fallback_vulkan_13_features = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+            .pNext = &fallback_vulkan_12_features,
+            .synchronization2 = VK_TRUE,
+            .dynamicRendering = VK_TRUE
+        };
+
+        // Every profile requires update-after-bind descriptor indexing, other devices have to be queried.
+        bool bindless_supported = tier_1_device_supported || tier_2_device_supported || tier_3_device_supported;
+        if (info.bindless && !bindless_supported) {
+            VkPhysicalDeviceVulkan12Features supported_vulkan_12_features = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+                .pNext = nullptr
+            };
+            VkPhysicalDeviceFeatures2 features = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                .pNext = &supported_vulkan_12_features
+            };
+            vkGetPhysicalDeviceFeatures2(m_physical_device, &features);
+            bindless_supported = supported_vulkan_12_features.descriptorBindingSampledImageUpdateAfterBind &&
+                supported_vulkan_12_features.descriptorBindingStorageImageUpdateAfterBind &&
+                supported_vulkan_12_features.descriptorBindingStorageBufferUpdateAfterBind &&
+                supported_vulkan_12_features.descriptorBindingPartiallyBound &&
+                supported_vulkan_12_features.descriptorBindingVariableDescriptorCount &&
+                supported_vulkan_12_features.runtimeDescriptorArray;
+            if (bindless_supported) {
+                fallback_vulkan_12_features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+                fallback_vulkan_12_features.descriptorBindingStorageImageUpdateAfterBind = VK_TRUE;
+                fallback_vulkan_12_features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+                fallback_vulkan_12_features.descriptorBindingPartiallyBound = VK_TRUE;
+                fallback_vulkan_12_features.descriptorBindingVariableDescriptorCount = VK_TRUE;
+                fallback_vulkan_12_features.runtimeDescriptorArray = VK_TRUE;
+            }
+        }
+        // Every profile requires buffer device addresses, the descriptor buffer check already queried them.
+        fallback_vulkan_12_features.bufferDeviceAddress = descriptor_buffer_supported;
+
         // TODO: add VK_CHECK
-        vpCreateDevice(m_physical_device, &profile_device_create_info, nullptr, &m_device);
+        if (tier_1_device_supported || tier_2_device_supported || tier_3_device_supported) {
+            vpCreateDevice(m_physical_device, &profile_device_create_info, nullptr, &m_device);
+        }
+        else {
+            fallback_vulkan_12_features.pNext = optional_features;
+            device_create_info.pNext = &fallback_vulkan_13_features;
+            vkCreateDevice(m_physical_device, &device_create_info, nullptr, &m_device);
+        }
         volkLoadDevice(m_device);
 
         if (graphics_queue_found) {
@@ -325,7 +556,7 @@ namespace ygg::vk
             .vkGetDeviceProcAddr = vkGetDeviceProcAddr
         };
         VmaAllocatorCreateInfo allocator_create_info = {
-            .flags = 0,
+            .flags = descriptor_buffer_supported ? VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT : 0u,
             .physicalDevice = m_physical_device,
             .device = m_device,
             .pVulkanFunctions = &allocator_vk_functions,
@@ -333,17 +564,34 @@ namespace ygg::vk
             .vulkanApiVersion = VK_API_VERSION_1_3
         };
         vmaCreateAllocator(&allocator_create_info, &m_allocator);
+        m_deferred_destruction_queue = std::make_unique<Deferred_destruction_queue>(m_device, m_allocator,
+            m_max_frames_in_flight);
+        m_pipeline_cache = std::make_unique<Pipeline_cache>(m_device, m_physical_device, info.pipeline_cache_path);
+        m_layout_cache = std::make_unique<Layout_cache>(m_device);
+        if (info.bindless && bindless_supported) {
+            m_bindless_heap = std::make_unique<Bindless_descriptor_heap>(m_device, *m_layout_cache,
+                clamp_bindless_descriptor_heap_info(m_physical_device, info.bindless_heap));
+        }
+        if (descriptor_buffer_supported) {
+            m_descriptor_buffer_properties = query_descriptor_buffer_properties(m_physical_device);
+            // Every frame in flight has its own transient descriptor buffer.
+            m_transient_descriptor_buffer_size = std::min(m_transient_descriptor_buffer_size,
+                m_descriptor_buffer_properties->address_space_size / m_max_frames_in_flight);
+        }
+        if (graphics_pipeline_library_supported) {
+            m_pipeline_library_cache = std::make_unique<Pipeline_library_cache>(m_device, m_pipeline_cache->handle());
+        }
+        m_pipeline_state_cache = std::make_unique<Pipeline_state_cache>(m_device, m_pipeline_cache->handle(),
+            m_pipeline_library_cache.get());
+        m_pipeline_compiler = std::make_unique<Pipeline_compiler>(m_device, m_pipeline_cache->handle(),
+            m_pipeline_library_cache.get(), info.pipeline_compiler_threads);
+
+        m_frame_timeline = create_timeline_semaphore(0);
+        m_compute_timeline = create_timeline_semaphore(0);
 
         m_frame_contexts.reserve(m_max_frames_in_flight);
         for (uint32_t i = 0; i < m_max_frames_in_flight; i++) {
             m_frame_contexts.emplace_back(std::make_unique<Frame_context>(*this));
-            
-            VkFenceCreateInfo fence_info = {
-                .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-                .pNext = nullptr,
-                .flags = VK_FENCE_CREATE_SIGNALED_BIT
-            };
-            vkCreateFence(m_device, &fence_info, nullptr, &m_frame_fences[i]);
         }
     }
 
@@ -351,19 +599,38 @@ namespace ygg::vk
     {
         device_wait_idle();
 
-        for (uint32_t i = 0; i < m_max_frames_in_flight; i++) {
-            vkDestroyFence(m_device, m_frame_fences[i], nullptr);
-        }
+        vkDestroySemaphore(m_device, m_frame_timeline, nullptr);
+        vkDestroySemaphore(m_device, m_compute_timeline, nullptr);
 
         m_frame_contexts.clear();
+        m_deferred_destruction_queue.reset();
+        m_pipeline_state_cache.reset();
+        m_pipeline_compiler.reset();
+        m_pipeline_library_cache.reset();
+        m_bindless_heap.reset();
+        m_layout_cache.reset();
+        m_pipeline_cache->save();
+        m_pipeline_cache.reset();
         vmaDestroyAllocator(m_allocator);
         vkDestroyDevice(m_device, nullptr);
-        vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
+        if (m_surface != VK_NULL_HANDLE) {
+            vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
+        }
         vkDestroyInstance(m_instance, nullptr); // TODO: add VK_CHECK
     }
 
     void Context::end_frame()
     {
+        if (!m_frame_completion_signaled) {
+            // Nothing signaled the frame value, so the frame is complete once all previous graphics work is.
+            Semaphore_signal_info signal_info = frame_completion_signal_info();
+            Submit submit_info = {
+                .await_semas = {},
+                .cmd_bufs = {},
+                .signal_semas = { &signal_info, 1 }
+            };
+            submit(m_graphics_queue.queue, submit_info, VK_NULL_HANDLE);
+        }
         m_current_frame_in_flight += 1;
         m_current_frame_in_flight %= m_max_frames_in_flight;
     }
@@ -375,8 +642,33 @@ namespace ygg::vk
 
     void Context::begin_frame()
     {
-        vkWaitForFences(m_device, 1, &m_frame_fences[m_current_frame_in_flight], VK_TRUE, ~0ull);
-        vkResetFences(m_device, 1, &m_frame_fences[m_current_frame_in_flight]);
+        // Async compute is not necessarily awaited by the submit signaling the frame value, so wait for both.
+        std::array<VkSemaphore, 2> wait_semaphores = { m_frame_timeline, m_compute_timeline };
+        std::array<uint64_t, 2> wait_values = {
+            m_frame_values[m_current_frame_in_flight],
+            m_frame_compute_values[m_current_frame_in_flight]
+        };
+        VkSemaphoreWaitInfo wait_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .semaphoreCount = uint32_t(wait_semaphores.size()),
+            .pSemaphores = wait_semaphores.data(),
+            .pValues = wait_values.data()
+        };
+        vkWaitSemaphores(m_device, &wait_info, ~0ull);
+        // Later frames may have finished their graphics work while their async compute work is still running,
+        // so only the awaited frame and the ones before it are known to be complete on both queues.
+        uint64_t completed_value = m_frame_values[m_current_frame_in_flight];
+
+        m_frame_value += 1;
+        m_frame_values[m_current_frame_in_flight] = m_frame_value;
+        m_frame_completion_signaled = false;
+        m_deferred_destruction_queue->drain(completed_value);
+        if (m_bindless_heap) {
+            m_bindless_heap->collect(completed_value);
+        }
+        m_pipeline_state_cache->collect_pipelines();
         frame_context().start_frame();
     }
 
@@ -385,47 +677,176 @@ namespace ygg::vk
         vk::update_descriptor_set(m_device, info);
     }
 
-    void Context::update_descriptor_sets(std::span<Descriptor_set_write_info> infos)
+    void Context::update_descriptor_sets(std::span<const Descriptor_set_write_info> infos)
     {
         vk::update_descriptor_sets(m_device, infos);
     }
 
-    Image Context::create_image(const Image_info& info, uint32_t initial_queue_family_index) const
+    void Context::batch_descriptor_set_write(const Descriptor_set_write_info& info)
     {
-        return vk::create_image(info, initial_queue_family_index, m_allocator, m_device);
+        frame_context().descriptor_write_batcher().push(info);
     }
 
-    Buffer Context::create_buffer(const Buffer_info& info, uint32_t initial_queue_family_index) const
+    void Context::batch_descriptor_set_writes(std::span<const Descriptor_set_write_info> infos)
     {
-        return vk::create_buffer(info, initial_queue_family_index, m_allocator, m_max_frames_in_flight);
+        frame_context().descriptor_write_batcher().push(infos);
     }
 
-    VkDescriptorSetLayout Context::create_descriptor_set_layout(const Descriptor_set_layout_info& info) const
+    void Context::flush_descriptor_writes()
     {
-        return vk::create_descriptor_set_layout(m_device, info);
+        frame_context().descriptor_write_batcher().flush();
     }
 
-    VkPipelineLayout Context::create_pipeline_layout(const Pipeline_layout_info& info) const
+    void Context::update_descriptor_set_with_template(VkDescriptorSet set,
+        VkDescriptorUpdateTemplate update_template, const void* data) const
     {
-        return vk::create_pipeline_layout(m_device, info);
+        vk::update_descriptor_set_with_template(m_device, set, update_template, data);
     }
 
-    Pipeline Context::create_graphics_pipeline(const Graphics_pipeline_info& info) const
+    Image Context::create_image(const Image_info& info, uint32_t initial_queue_family_index, bool bindless) const
     {
-        Pipeline result = {};
-        result.handle = vk::create_graphics_pipeline(m_device, info);
-        result.bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        auto result = vk::create_image(info, initial_queue_family_index, m_allocator, m_device);
+        if (bindless) {
+            assert(m_bindless_heap && "Registering an image without a bindless heap.");
+            if (info.usage & VK_IMAGE_USAGE_SAMPLED_BIT) {
+                result.bindless_sampled_index = m_bindless_heap->register_sampled_image(
+                    result.allocated_image.default_view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            }
+            if (info.usage & VK_IMAGE_USAGE_STORAGE_BIT) {
+                result.bindless_storage_index = m_bindless_heap->register_storage_image(
+                    result.allocated_image.default_view);
+            }
+        }
         return result;
     }
 
-    Pipeline Context::create_compute_pipeline(const Compute_pipeline_info& info) const
+    Buffer Context::create_buffer(const Buffer_info& info, uint32_t initial_queue_family_index, bool bindless) const
     {
-        Pipeline result = {};
-        result.handle = vk::create_compute_pipeline(m_device, info);
-        result.bind_point = VK_PIPELINE_BIND_POINT_COMPUTE;
+        auto buffer_info = info;
+        // Descriptor buffers reference uniform and storage buffers by their device address and an explicit range.
+        bool descriptor_buffer_range = m_descriptor_buffer_properties &&
+            (info.usage & (VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
+        if (descriptor_buffer_range) {
+            buffer_info.usage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+        }
+        auto result = vk::create_buffer(buffer_info, initial_queue_family_index, m_allocator, m_max_frames_in_flight);
+        if (descriptor_buffer_range) {
+            for (uint32_t i = 0; i < get_allocated_buffer_count(info.domain, m_max_frames_in_flight); i++) {
+                m_descriptor_buffer_range_sizes[result.allocated_buffers[i].handle] = info.size;
+            }
+        }
+        if (bindless) {
+            assert(m_bindless_heap && "Registering a buffer without a bindless heap.");
+            assert(info.domain != Buffer_domain::Device_host_visible
+                && "Buffers with one allocation per frame in flight can't have a single bindless index.");
+            assert((info.usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT) && "Bindless buffers must be storage buffers.");
+            result.bindless_index = m_bindless_heap->register_storage_buffer(
+                result.allocated_buffers[0].handle, 0, VK_WHOLE_SIZE);
+        }
         return result;
     }
 
+    VkDescriptorSetLayoutCreateFlags Context::transient_descriptor_set_layout_flags() const
+    {
+        return m_descriptor_buffer_properties ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT : 0;
+    }
+
+    VkPipelineCreateFlags Context::transient_pipeline_create_flags() const
+    {
+        return m_descriptor_buffer_properties ? VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT : 0;
+    }
+
+    void Context::release_bindless_indices(const Image& image) const
+    {
+        if (m_bindless_heap) {
+            m_bindless_heap->release(Bindless_resource_type::Sampled_image, image.bindless_sampled_index, m_frame_value);
+            m_bindless_heap->release(Bindless_resource_type::Storage_image, image.bindless_storage_index, m_frame_value);
+        }
+    }
+
+    void Context::release_bindless_indices(const Buffer& buffer) const
+    {
+        if (m_bindless_heap) {
+            m_bindless_heap->release(Bindless_resource_type::Storage_buffer, buffer.bindless_index, m_frame_value);
+        }
+    }
+
+    void Context::release_descriptor_buffer_range_sizes(const Buffer& buffer) const
+    {
+        if (m_descriptor_buffer_range_sizes.empty()) {
+            return;
+        }
+        for (uint32_t i = 0; i < get_allocated_buffer_count(buffer.info.domain, m_max_frames_in_flight); i++) {
+            m_descriptor_buffer_range_sizes.erase(buffer.allocated_buffers[i].handle);
+        }
+    }
+
+    VkDeviceSize Context::descriptor_buffer_range_size(VkBuffer buffer) const
+    {
+        auto it = m_descriptor_buffer_range_sizes.find(buffer);
+        return it != m_descriptor_buffer_range_sizes.end() ? it->second : 0;
+    }
+
+    void Context::flush_bindless_writes() const
+    {
+        // The sets are update-after-bind, so registrations only have to be written before the submit.
+        if (m_bindless_heap) {
+            m_bindless_heap->flush_writes();
+        }
+    }
+
+    VkDescriptorSetLayout Context::create_descriptor_set_layout(const Descriptor_set_layout_info& info)
+    {
+        assert((m_push_descriptor_supported || !(info.flags & VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR))
+            && "Push descriptors are not supported.");
+        if (info.flags & VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT) {
+            for (const auto& binding : info.bindings) {
+                if (!is_transient_descriptor_buffer_type(binding.type)) {
+                    // TODO: logging?
+                    printf("Descriptor type %d is not supported by transient descriptor buffers.", int(binding.type));
+                    std::abort();
+                }
+            }
+        }
+        return m_layout_cache->acquire_descriptor_set_layout(info);
+    }
+
+    VkDescriptorUpdateTemplate Context::create_descriptor_update_template(
+        const Descriptor_update_template_info& info) const
+    {
+        return vk::create_descriptor_update_template(m_device, info);
+    }
+
+    VkPipelineLayout Context::create_pipeline_layout(const Pipeline_layout_info& info)
+    {
+        return m_layout_cache->acquire_pipeline_layout(info.layouts, info.push_constant_ranges);
+    }
+
+    Reflected_pipeline_layout Context::create_pipeline_layout(const Shader_reflection& reflection)
+    {
+        return m_layout_cache->acquire_pipeline_layout(reflection);
+    }
+
+    Pipeline Context::create_graphics_pipeline(const Graphics_pipeline_info& info)
+    {
+        return m_pipeline_state_cache->acquire_graphics_pipeline(info);
+    }
+
+    Pipeline Context::create_compute_pipeline(const Compute_pipeline_info& info)
+    {
+        return m_pipeline_state_cache->acquire_compute_pipeline(info);
+    }
+
+    Async_pipeline Context::create_graphics_pipeline_async(const Graphics_pipeline_info& info)
+    {
+        return m_pipeline_state_cache->acquire_graphics_pipeline_async(info, *m_pipeline_compiler);
+    }
+
+    Async_pipeline Context::create_compute_pipeline_async(const Compute_pipeline_info& info)
+    {
+        return m_pipeline_state_cache->acquire_compute_pipeline_async(info, *m_pipeline_compiler);
+    }
+
     Shader_module Context::create_shader_module(std::span<uint32_t> spirv, VkShaderStageFlagBits stage) const
     {
         return vk::create_shader_module(m_device, spirv, stage);
@@ -449,34 +870,83 @@ namespace ygg::vk
         return result;
     }
 
+    VkSemaphore Context::create_timeline_semaphore(uint64_t initial_value) const
+    {
+        VkSemaphore result = VK_NULL_HANDLE;
+        VkSemaphoreTypeCreateInfo type_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+            .pNext = nullptr,
+            .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+            .initialValue = initial_value
+        };
+        VkSemaphoreCreateInfo info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+            .pNext = &type_info,
+            .flags = 0
+        };
+        vkCreateSemaphore(m_device, &info, nullptr, &result);
+        return result;
+    }
+
     Allocated_buffer Context::select_allocated_buffer(const Buffer& buf) const
     {
         return vk::select_allocated_buffer(buf, m_current_frame_in_flight);
     }
 
+    bool Context::save_pipeline_cache() const
+    {
+        return m_pipeline_cache->save();
+    }
+
     void Context::destroy_image(Image& image) const
     {
+        release_bindless_indices(image);
         vk::destroy_image(image, m_allocator, m_device);
     }
 
     void Context::destroy_buffer(Buffer& buffer) const
     {
+        release_bindless_indices(buffer);
+        release_descriptor_buffer_range_sizes(buffer);
         vk::destroy_buffer(buffer, m_allocator, m_max_frames_in_flight);
     }
 
-    void Context::destroy_descriptor_set_layout(VkDescriptorSetLayout layout) const
+    void Context::destroy_descriptor_set_layout(VkDescriptorSetLayout layout)
     {
-        vkDestroyDescriptorSetLayout(m_device, layout, nullptr);
+        if (m_layout_cache->release_descriptor_set_layout(layout)) {
+            vkDestroyDescriptorSetLayout(m_device, layout, nullptr);
+        }
     }
 
-    void Context::destroy_pipeline_layout(VkPipelineLayout layout) const
+    void Context::destroy_descriptor_update_template(VkDescriptorUpdateTemplate update_template) const
     {
-        vkDestroyPipelineLayout(m_device, layout, nullptr);
+        vkDestroyDescriptorUpdateTemplate(m_device, update_template, nullptr);
     }
 
-    void Context::destroy_pipeline(Pipeline& pipeline) const
+    void Context::destroy_pipeline_layout(VkPipelineLayout layout)
     {
-        vk::destroy_pipeline(m_device, pipeline);
+        std::vector<VkDescriptorSetLayout> released_set_layouts = {};
+        if (m_layout_cache->release_pipeline_layout(layout, released_set_layouts)) {
+            vkDestroyPipelineLayout(m_device, layout, nullptr);
+        }
+        for (auto set_layout : released_set_layouts) {
+            vkDestroyDescriptorSetLayout(m_device, set_layout, nullptr);
+        }
+    }
+
+    void Context::destroy_pipeline_layout(const Reflected_pipeline_layout& layout)
+    {
+        destroy_pipeline_layout(layout.layout);
+        for (auto set_layout : layout.set_layouts) {
+            destroy_descriptor_set_layout(set_layout);
+        }
+    }
+
+    void Context::destroy_pipeline(Pipeline& pipeline)
+    {
+        if (m_pipeline_state_cache->release_pipeline(pipeline)) {
+            vk::destroy_pipeline(m_device, pipeline);
+        }
     }
 
     void Context::destroy_shader_module(Shader_module& shader) const
@@ -484,6 +954,77 @@ namespace ygg::vk
         vk::destroy_shader_module(m_device, shader);
     }
 
+    void Context::zombify_buffer(const Buffer& buffer)
+    {
+        release_bindless_indices(buffer);
+        release_descriptor_buffer_range_sizes(buffer);
+        m_deferred_destruction_queue->push_buffer(buffer, m_frame_value);
+    }
+
+    void Context::zombify_image(const Image& image)
+    {
+        release_bindless_indices(image);
+        m_deferred_destruction_queue->push_image(image, m_frame_value);
+    }
+
+    void Context::zombify_image_view(VkImageView view)
+    {
+        m_deferred_destruction_queue->push_image_view(view, m_frame_value);
+    }
+
+    void Context::zombify_pipeline(const Pipeline& pipeline)
+    {
+        if (m_pipeline_state_cache->release_pipeline(pipeline)) {
+            m_deferred_destruction_queue->push_pipeline(pipeline, m_frame_value);
+        }
+    }
+
+    void Context::zombify_pipeline_layout(VkPipelineLayout layout)
+    {
+        std::vector<VkDescriptorSetLayout> released_set_layouts = {};
+        if (m_layout_cache->release_pipeline_layout(layout, released_set_layouts)) {
+            m_deferred_destruction_queue->push_pipeline_layout(layout, m_frame_value);
+        }
+        for (auto set_layout : released_set_layouts) {
+            m_deferred_destruction_queue->push_descriptor_set_layout(set_layout, m_frame_value);
+        }
+    }
+
+    void Context::zombify_pipeline_layout(const Reflected_pipeline_layout& layout)
+    {
+        zombify_pipeline_layout(layout.layout);
+        for (auto set_layout : layout.set_layouts) {
+            zombify_descriptor_set_layout(set_layout);
+        }
+    }
+
+    void Context::zombify_descriptor_set_layout(VkDescriptorSetLayout layout)
+    {
+        if (m_layout_cache->release_descriptor_set_layout(layout)) {
+            m_deferred_destruction_queue->push_descriptor_set_layout(layout, m_frame_value);
+        }
+    }
+
+    void Context::zombify_descriptor_pool(VkDescriptorPool pool)
+    {
+        m_deferred_destruction_queue->push_descriptor_pool(pool, m_frame_value);
+    }
+
+    void Context::zombify_shader_module(const Shader_module& shader)
+    {
+        m_deferred_destruction_queue->push_shader_module(shader, m_frame_value);
+    }
+
+    void Context::zombify_semaphore(VkSemaphore semaphore)
+    {
+        m_deferred_destruction_queue->push_semaphore(semaphore, m_frame_value);
+    }
+
+    void Context::zombify_fence(VkFence fence)
+    {
+        m_deferred_destruction_queue->push_fence(fence, m_frame_value);
+    }
+
     VkResult Context::submit_simple(VkQueue queue, VkCommandBuffer cmdbuf,
         VkSemaphore await_sema, VkSemaphore signal_sema, VkFence signal_fence)
     {
@@ -519,6 +1060,8 @@ namespace ygg::vk
             .signalSemaphoreInfoCount = signal_sema == VK_NULL_HANDLE ? 0u : 1u,
             .pSignalSemaphoreInfos = &signal_info
         };
+        flush_descriptor_writes();
+        flush_bindless_writes();
         return vkQueueSubmit2(queue, 1, &submit_info, signal_fence);
     }
 
@@ -571,6 +1114,62 @@ namespace ygg::vk
             .signalSemaphoreInfoCount = uint32_t(signal_infos.size()),
             .pSignalSemaphoreInfos = signal_infos.data()
         };
+        flush_descriptor_writes();
+        flush_bindless_writes();
         return vkQueueSubmit2(queue, 1, &submit_info, signal_fence);
     }
+
+    uint64_t Context::submit_async_compute(std::span<VkCommandBuffer> cmd_bufs, std::span<Semaphore_signal_info> await_semas)
+    {
+        uint64_t value = ++m_compute_value;
+        Semaphore_signal_info signal_info = {
+            .semaphore = m_compute_timeline,
+            .value = value,
+            .stage_mask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+        };
+        Submit submit_info = {
+            .await_semas = await_semas,
+            .cmd_bufs = cmd_bufs,
+            .signal_semas = { &signal_info, 1 }
+        };
+        submit(m_compute_queue.queue, submit_info, VK_NULL_HANDLE);
+        m_frame_compute_values[m_current_frame_in_flight] = value;
+        return value;
+    }
+
+    Semaphore_signal_info Context::async_compute_wait_info(uint64_t value, VkPipelineStageFlags2 stage_mask) const
+    {
+        return { m_compute_timeline, value, stage_mask };
+    }
+
+    void Context::wait_for_previous_frame() const
+    {
+        VkSemaphoreWaitInfo wait_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .semaphoreCount = 1,
+            .pSemaphores = &m_frame_timeline,
+            .pValues = &m_frame_value
+        };
+        vkWaitSemaphores(m_device, &wait_info, ~0ull);
+    }
+
+    Semaphore_signal_info Context::frame_completion_signal_info()
+    {
+        m_frame_completion_signaled = true;
+        return { m_frame_timeline, m_frame_value, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT };
+    }
+
+    uint64_t Context::completed_frame_value() const
+    {
+        uint64_t result = 0;
+        vkGetSemaphoreCounterValue(m_device, m_frame_timeline, &result);
+        return result;
+    }
+
+    bool Context::is_frame_complete(uint64_t frame_value) const
+    {
+        return completed_frame_value() >= frame_value;
+    }
 }
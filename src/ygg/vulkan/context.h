@@ -2,13 +2,24 @@
 
 #pragma once
 
+#include "ygg/vulkan/bindless_descriptor_heap.h"
+#include "ygg/vulkan/descriptor_buffer.h"
 #include "ygg/vulkan/descriptors.h"
 #include "ygg/vulkan/linear_host_resource_allocator.h"
 #include "ygg/vulkan/command_buffer_recycler.h"
+#include "ygg/vulkan/deferred_destruction_queue.h"
+#include "ygg/vulkan/layout_cache.h"
+#include "ygg/vulkan/pipeline_cache.h"
+#include "ygg/vulkan/pipeline_compiler.h"
+#include "ygg/vulkan/pipeline_library_cache.h"
+#include "ygg/vulkan/pipeline_state_cache.h"
 #include "ygg/vulkan/resource.h"
 #include "ygg/vulkan/vk_forward_decl.h"
 
 #include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace ygg::vk
@@ -45,6 +56,15 @@ namespace ygg::vk
         Tier_3
     };
 
+    /**
+     * @brief Descriptors that are only used in the current frame, see `Frame_context::allocate_transient_descriptors`.
+    */
+    struct Transient_descriptors
+    {
+        VkDescriptorSet set; // VK_NULL_HANDLE if the descriptors live in the transient descriptor buffer.
+        Descriptor_buffer_allocation buffer_allocation;
+    };
+
     /**
      * @brief Per-frame "sub"-Context.
     */
@@ -54,18 +74,27 @@ namespace ygg::vk
         /**
          * @brief Constructs a Frame_context instance that is bound to the Context.
         */
-        Frame_context(const Context& context);
+        Frame_context(Context& context);
         ~Frame_context();
 
         /**
-         * @brief Begins this Frame, clearing any allocators, command buffers and zombies.
+         * @brief Begins this Frame, clearing any allocators and command buffers.
         */
         void start_frame();
 
         /**
          * @brief Acquires a Linear_host_resource_allocator that is bound to this Frame_context.
+         * @param queue_family_index The queue family index the allocated staging memory is used on.
         */
-        Linear_host_resource_allocator& acquire_linear_host_resource_allocator();
+        Linear_host_resource_allocator& acquire_linear_host_resource_allocator(uint32_t queue_family_index);
+
+        /**
+         * @brief Returns the staging memory usage of the last frame that used this Frame_context.
+        */
+        inline const Linear_host_resource_allocator_statistics& staging_statistics() const
+        {
+            return m_linear_host_resource_allocator_provider.statistics();
+        }
 
         /**
          * @brief Acquires a Compute_command_buffer that is bound to this Frame_context.
@@ -82,30 +111,65 @@ namespace ygg::vk
         */
         VkDescriptorSet allocate_transient_descriptor_set(VkDescriptorSetLayout layout);
 
+        /**
+         * @brief Allocates descriptors that are only used in the current frame.
+         * @details If descriptor buffers are used and the layout was created with
+         * `Context::transient_descriptor_set_layout_flags`, the descriptors are bump allocated from the
+         * transient descriptor buffer. Otherwise a descriptor set is allocated from the transient pools.
+        */
+        Transient_descriptors allocate_transient_descriptors(VkDescriptorSetLayout layout);
+
+        /**
+         * @brief Writes the descriptors, the `set` member of the write infos is ignored.
+         * @details Descriptor buffer writes are immediate, descriptor set writes are batched and flushed
+         * by `bind_transient_descriptors`.
+        */
+        void write_transient_descriptors(const Transient_descriptors& descriptors,
+            std::span<const Descriptor_set_write_info> write_infos);
+
+        /**
+         * @brief Binds the descriptors to the given set index of the pipeline layout.
+         * @details The transient descriptor buffer is bound on the first use of each command buffer, later binds
+         * only set the offset. Binding other descriptor buffers to the command buffer afterwards is not allowed.
+        */
+        void bind_transient_descriptors(const Compute_command_buffer& cmdbuf, VkPipelineBindPoint bind_point,
+            VkPipelineLayout layout, uint32_t set_offset, const Transient_descriptors& descriptors);
+
+        /**
+         * @brief Returns the transient descriptor buffer if descriptor buffers are used, otherwise nullptr.
+        */
+        inline const Transient_descriptor_buffer* transient_descriptor_buffer() const
+        {
+            return m_transient_descriptor_buffer.get();
+        }
+
+        /**
+         * @brief Returns the Descriptor_write_batcher that collects the descriptor writes of this frame.
+         * @details Its statistics are reset on `start_frame`.
+        */
+        inline Descriptor_write_batcher& descriptor_write_batcher() { return m_descriptor_write_batcher; }
+
         /**
         * Zombify-methods are used to declare that a resource is a zombie. Any zombified resource
-        * will be destroyed once this frame in flight is hit the next time. That means either either
-        * two or three frames. This is useful for resources such as semaphores when acquiring an image
-        * from an swapchain or when having any "transient" submit where a fence is required.
+        * will be destroyed once the current frame completed on the GPU. This is useful for resources
+        * such as semaphores when acquiring an image from an swapchain or when having any "transient"
+        * submit where a fence is required. See `Context::zombify_semaphore` and `Context::zombify_fence`.
         * A zombified resource can still be used in the current frame but should not be used in any
         * further frame. Further use can lead to deleting a resource before it's consumed.
         */
 
-        inline void zombify_semaphore(VkSemaphore semaphore) { m_zombie_semaphores.emplace_back(semaphore); };
-        inline void zombify_fence(VkFence fence) { m_zombie_fences.emplace_back(fence); };
-
-    private:
-        void destroy_all_zombies();
+        void zombify_semaphore(VkSemaphore semaphore);
+        void zombify_fence(VkFence fence);
 
     private:
-        const Context& m_context;
+        Context& m_context;
         Linear_host_resource_allocator_provider m_linear_host_resource_allocator_provider;
         Command_buffer_recycler m_graphics_command_buffer_recycler;
         Command_buffer_recycler m_async_compute_command_buffer_recycler;
         std::unique_ptr<Transient_descriptor_set_allocator> m_transient_descriptor_set_allocator;
-
-        std::vector<VkSemaphore> m_zombie_semaphores = {};
-        std::vector<VkFence> m_zombie_fences = {};
+        std::unique_ptr<Transient_descriptor_buffer> m_transient_descriptor_buffer;
+        std::vector<VkCommandBuffer> m_descriptor_buffer_command_buffers = {};
+        Descriptor_write_batcher m_descriptor_write_batcher;
     };
 
     struct Queue
@@ -128,6 +192,58 @@ namespace ygg::vk
         std::span<Semaphore_signal_info> signal_semas;
     };
 
+    /**
+     * @brief Runtime configuration of a Context.
+    */
+    struct Context_info
+    {
+        /**
+         * The amount of frames the CPU may record ahead of the GPU.
+         * Clamped between 1 and `YGG_MAX_FRAMES_IN_FLIGHT`.
+        */
+        uint32_t max_frames_in_flight = 2;
+
+        /**
+         * If set, `wait_for_previous_frame` should be called right before sampling input,
+         * trading throughput for lower input-to-photon latency.
+        */
+        bool low_latency = false;
+
+        /**
+         * The file the pipeline cache is loaded from on creation and saved to on destruction.
+         * If empty, the pipeline cache is not persisted.
+        */
+        std::string pipeline_cache_path = "pipeline_cache.bin";
+
+        /**
+         * Amount of threads compiling pipelines created by `create_*_pipeline_async`.
+         * If zero, one thread per hardware thread is used.
+        */
+        uint32_t pipeline_compiler_threads = 0;
+
+        /**
+         * If set and the device supports VK_EXT_graphics_pipeline_library with fast linking, graphics pipelines
+         * are linked from cached library parts instead of being compiled as a whole.
+        */
+        bool graphics_pipeline_library = true;
+
+        /**
+         * If set and the device supports update-after-bind descriptor indexing, a bindless descriptor heap is
+         * created. The capacities are clamped to the limits of the device.
+        */
+        bool bindless = true;
+        Bindless_descriptor_heap_info bindless_heap = {};
+
+        /**
+         * If set and the device supports VK_EXT_descriptor_buffer, transient descriptors of layouts created with
+         * `Context::transient_descriptor_set_layout_flags` are written into a per-frame descriptor buffer of the
+         * given size instead of being allocated from descriptor pools. The size is clamped to the limits of
+         * the device.
+        */
+        bool descriptor_buffer = true;
+        VkDeviceSize transient_descriptor_buffer_size = 4 * 1024 * 1024;
+    };
+
     /**
      * @brief A simple Context for Vulkan applications.
      * @details Initializes Vulkan completely to be used.
@@ -138,14 +254,18 @@ namespace ygg::vk
     public:
         /**
          * @brief Constructs a Context instance and binds the WSI to it.
+         * @details If the WSI does not create a surface the Context is headless.
+         * Headless Contexts can only render into offscreen images.
         */
-        explicit Context(const Window_system_integration& wsi);
+        explicit Context(const Window_system_integration& wsi, const Context_info& info = {});
         ~Context();
 
         /**
          * @brief Ends the current frame.
          * @details Let n be the current frame in flight.
          * This sets n to n + 1 % max_frames_in_flight.
+         * If no submit used `frame_completion_signal_info` in this frame, an empty submit signaling
+         * the frame value is issued to the graphics queue.
         */
         void end_frame();
 
@@ -158,37 +278,219 @@ namespace ygg::vk
 
         /**
          * @brief Starts the current frame in flight.
-         * @details This will clear any zombified resource and reset all command buffers and allocators.
+         * @details Waits until the frame that last used this frame in flight completed, then increments
+         * the frame value. This will clear any zombified resource and reset all command buffers and allocators.
         */
         void begin_frame();
 
-        /*
-        * Descriptor updates
+        /**
+         * @brief Blocks until the GPU completed the previous frame.
+         * @details Meant to be called before sampling input in low latency mode, so the sampled input is
+         * presented as soon as possible instead of being queued behind other frames in flight.
+        */
+        void wait_for_previous_frame() const;
+
+        /**
+         * @brief Returns the signal info completing the current frame.
+         * @details The frame timeline semaphore is signaled with the current frame value. Must be used by
+         * exactly one submit per frame, which has to wait on all other submits of the frame it depends on,
+         * as the frame in flight's resources are recycled once the value is reached.
+        */
+        Semaphore_signal_info frame_completion_signal_info();
+
+        /**
+         * @brief Returns the value of the most recent frame which completed on the GPU.
+         * @details This only queries the counter of the frame timeline semaphore and never blocks.
+        */
+        uint64_t completed_frame_value() const;
+
+        /**
+         * @brief Returns whether or not the frame with the given value completed on the GPU.
+        */
+        bool is_frame_complete(uint64_t frame_value) const;
+
+        /**
+         * @brief Updates the descriptor set immediately.
+         * @details The set must not be used by a pending command buffer, unless the written bindings
+         * are update-after-bind.
         */
         void update_descriptor_set(const Descriptor_set_write_info& info);
-        void update_descriptor_sets(std::span<Descriptor_set_write_info> infos);
+        void update_descriptor_sets(std::span<const Descriptor_set_write_info> infos);
+
+        /**
+         * @brief Queues the writes in the current frame's Descriptor_write_batcher instead of applying them.
+         * @details Batched writes are only applied by `flush_descriptor_writes`, which must be called before
+         * any of the written sets is bound. Writes that are still pending when submitting are flushed by the
+         * submit, which is only valid for sets that were not bound yet.
+        */
+        void batch_descriptor_set_write(const Descriptor_set_write_info& info);
+        void batch_descriptor_set_writes(std::span<const Descriptor_set_write_info> infos);
+
+        /**
+         * @brief Applies all writes queued by `batch_descriptor_set_write(s)` in the current frame.
+        */
+        void flush_descriptor_writes();
+
+        /**
+         * @brief Updates the set from raw data laid out as described by the template, bypassing the batch.
+         * @details The update is applied immediately, so it is ordered before any pending batched write.
+        */
+        void update_descriptor_set_with_template(VkDescriptorSet set, VkDescriptorUpdateTemplate update_template,
+            const void* data) const;
 
         /**
          * Resource creation and destruction methods.
         */
 
-        Image create_image(const Image_info& info, uint32_t initial_queue_family_index) const;
-        Buffer create_buffer(const Buffer_info& info, uint32_t initial_queue_family_index) const;
-        VkDescriptorSetLayout create_descriptor_set_layout(const Descriptor_set_layout_info& info) const;
-        VkPipelineLayout create_pipeline_layout(const Pipeline_layout_info& info) const;
-        Pipeline create_graphics_pipeline(const Graphics_pipeline_info& info) const;
-        Pipeline create_compute_pipeline(const Compute_pipeline_info& info) const;
+        /**
+         * @brief Creates an image, optionally registering it in the bindless heap.
+         * @details If `bindless` is set, the heap must exist. The image is registered as sampled and/or storage
+         * image depending on its usage. The indices are released again by the matching destroy or zombify call,
+         * and are only reused once the current frame completed on the GPU.
+        */
+        Image create_image(const Image_info& info, uint32_t initial_queue_family_index, bool bindless = false) const;
+
+        /**
+         * @brief Creates a buffer, optionally registering it in the bindless heap as storage buffer.
+         * @details If `bindless` is set, the heap must exist. Buffers in the `Device_host_visible` domain can't be
+         * registered. The index is released again like the indices of images.
+        */
+        Buffer create_buffer(const Buffer_info& info, uint32_t initial_queue_family_index, bool bindless = false) const;
+
+        /**
+         * @brief Creates a descriptor set layout or returns the equal layout that already exists.
+         * @details Layouts are shared through the layout cache. Every creation adds a reference,
+         * which is released by the matching destroy or zombify call.
+        */
+        VkDescriptorSetLayout create_descriptor_set_layout(const Descriptor_set_layout_info& info);
+
+        /**
+         * @brief Creates a pipeline layout or returns the equal layout that already exists.
+         * @details Shared and reference counted like set layouts. The set layouts must be created by this context.
+        */
+        VkPipelineLayout create_pipeline_layout(const Pipeline_layout_info& info);
+
+        /**
+         * @brief Creates the set layouts and pipeline layout described by the reflection.
+         * @details Every layout gains a reference, released together by the matching destroy or zombify call.
+        */
+        Reflected_pipeline_layout create_pipeline_layout(const Shader_reflection& reflection);
+
+        /**
+         * @brief Creates a template for updating descriptor sets from a single block of host memory.
+        */
+        VkDescriptorUpdateTemplate create_descriptor_update_template(const Descriptor_update_template_info& info) const;
+
+        /**
+         * @brief Destroys the template immediately.
+         * @details Templates are only used by the host, so they can be destroyed as soon as no update using them
+         * is recorded anymore.
+        */
+        void destroy_descriptor_update_template(VkDescriptorUpdateTemplate update_template) const;
+
+        /**
+         * @brief Creates a graphics pipeline or returns the existing pipeline with the same state.
+         * @details Pipelines are shared through the pipeline state cache. Every creation adds a reference,
+         * which is released by the matching destroy or zombify call.
+        */
+        Pipeline create_graphics_pipeline(const Graphics_pipeline_info& info);
+
+        /**
+         * @brief Creates a compute pipeline or returns the existing pipeline with the same state.
+         * @details Shared and reference counted like graphics pipelines.
+        */
+        Pipeline create_compute_pipeline(const Compute_pipeline_info& info);
+
+        /**
+         * @brief Starts compiling a graphics pipeline on a worker thread without waiting for it to be ready.
+         * @details The result can be polled without blocking the render thread. The shader modules and layout
+         * must stay alive until the pipeline is ready. A pipeline must be ready before it can be destroyed or zombified.
+        */
+        Async_pipeline create_graphics_pipeline_async(const Graphics_pipeline_info& info);
+
+        /**
+         * @brief Starts compiling a compute pipeline on a worker thread without waiting for it to be ready.
+         * @details The same lifetime rules as for `create_graphics_pipeline_async` apply.
+        */
+        Async_pipeline create_compute_pipeline_async(const Compute_pipeline_info& info);
+
         Shader_module create_shader_module(std::span<uint32_t> spirv, VkShaderStageFlagBits stage) const;
         VkSemaphore create_binary_semaphore() const;
+        VkSemaphore create_timeline_semaphore(uint64_t initial_value) const;
         Allocated_buffer select_allocated_buffer(const Buffer& buf) const;
 
+        /**
+         * @brief Writes the pipeline cache to disk. This is done automatically on destruction.
+         * @return Whether or not the cache was written.
+        */
+        bool save_pipeline_cache() const;
+
         void destroy_image(Image& image) const;
         void destroy_buffer(Buffer& buffer) const;
-        void destroy_descriptor_set_layout(VkDescriptorSetLayout layout) const;
-        void destroy_pipeline_layout(VkPipelineLayout layout) const;
-        void destroy_pipeline(Pipeline& pipeline) const;
+        void destroy_descriptor_set_layout(VkDescriptorSetLayout layout);
+        void destroy_pipeline_layout(VkPipelineLayout layout);
+        void destroy_pipeline_layout(const Reflected_pipeline_layout& layout);
+        void destroy_pipeline(Pipeline& pipeline);
         void destroy_shader_module(Shader_module& shader) const;
 
+        /**
+         * @brief Destroys the buffer once the current frame completed on the GPU.
+         * @details Zombify-methods don't wait for the device to idle, the zombies are drained in `begin_frame`.
+         * A zombified resource can still be used in the current frame but must not be used in any further frame.
+        */
+        void zombify_buffer(const Buffer& buffer);
+
+        /**
+         * @brief Destroys the image and its default view once the current frame completed on the GPU.
+        */
+        void zombify_image(const Image& image);
+
+        /**
+         * @brief Destroys the image view once the current frame completed on the GPU.
+        */
+        void zombify_image_view(VkImageView view);
+
+        /**
+         * @brief Releases the reference to the pipeline once the current frame completed on the GPU.
+        */
+        void zombify_pipeline(const Pipeline& pipeline);
+
+        /**
+         * @brief Releases the reference to the pipeline layout once the current frame completed on the GPU.
+        */
+        void zombify_pipeline_layout(VkPipelineLayout layout);
+
+        /**
+         * @brief Releases the references to the pipeline layout and its set layouts once the current frame
+         * completed on the GPU.
+        */
+        void zombify_pipeline_layout(const Reflected_pipeline_layout& layout);
+
+        /**
+         * @brief Releases the reference to the set layout once the current frame completed on the GPU.
+        */
+        void zombify_descriptor_set_layout(VkDescriptorSetLayout layout);
+
+        /**
+         * @brief Destroys the descriptor pool once the current frame completed on the GPU.
+        */
+        void zombify_descriptor_pool(VkDescriptorPool pool);
+
+        /**
+         * @brief Destroys the shader module once the current frame completed on the GPU.
+        */
+        void zombify_shader_module(const Shader_module& shader);
+
+        /**
+         * @brief Destroys the semaphore once the current frame completed on the GPU.
+        */
+        void zombify_semaphore(VkSemaphore semaphore);
+
+        /**
+         * @brief Destroys the fence once the current frame completed on the GPU.
+        */
+        void zombify_fence(VkFence fence);
+
         /**
          * @brief Use for quickly submitting a single command buffer to a queue.
          * @details The semaphores are optional and may be VK_NULL_HANDLE.
@@ -200,6 +502,23 @@ namespace ygg::vk
 
         VkResult submit(VkQueue queue, const Submit& info, VkFence signal_fence);
 
+        /**
+         * @brief Submits command buffers acquired by `Frame_context::acquire_async_compute_command_buffer` to the compute queue.
+         * @details The submit signals the compute timeline semaphore, graphics submits consuming the results wait on
+         * the returned value using `async_compute_wait_info`. If the compute queue family differs from the graphics queue
+         * family, resources created with exclusive sharing mode require queue family ownership transfers.
+         * `begin_frame` waits for the last async compute submit of the frame in flight before recycling its command buffers.
+         * @param cmd_bufs The command buffers to submit.
+         * @param await_semas Semaphores to wait on before executing the command buffers.
+         * @return The value the compute timeline semaphore is set to after the command buffers completed.
+        */
+        uint64_t submit_async_compute(std::span<VkCommandBuffer> cmd_bufs, std::span<Semaphore_signal_info> await_semas = {});
+
+        /**
+         * @brief Returns the wait info for a submit that consumes the results of the async compute submit with the given value.
+        */
+        Semaphore_signal_info async_compute_wait_info(uint64_t value, VkPipelineStageFlags2 stage_mask) const;
+
         /**
          * @return The frame context for the current frame in flight.
         */
@@ -211,11 +530,66 @@ namespace ygg::vk
         inline VmaAllocator allocator() const { return m_allocator; }
         inline VkDevice device() const { return m_device; }
         inline VkPhysicalDevice physical_device() const { return m_physical_device; }
+        inline VkPipelineCache pipeline_cache() const { return m_pipeline_cache->handle(); }
+        inline const Layout_cache& layout_cache() const { return *m_layout_cache; }
+        inline const Pipeline_state_cache& pipeline_state_cache() const { return *m_pipeline_state_cache; }
+
+        /**
+         * @brief Returns the library cache if graphics pipeline libraries are used, otherwise nullptr.
+        */
+        inline const Pipeline_library_cache* pipeline_library_cache() const { return m_pipeline_library_cache.get(); }
+
+        /**
+         * @brief Returns the bindless descriptor heap if it is supported and enabled, otherwise nullptr.
+        */
+        inline Bindless_descriptor_heap* bindless_heap() const { return m_bindless_heap.get(); }
+
+        /**
+         * @brief Returns the descriptor buffer properties if descriptor buffers are used, otherwise nullptr.
+        */
+        inline const Descriptor_buffer_properties* descriptor_buffer_properties() const
+        {
+            return m_descriptor_buffer_properties ? &m_descriptor_buffer_properties.value() : nullptr;
+        }
+        inline VkDeviceSize transient_descriptor_buffer_size() const { return m_transient_descriptor_buffer_size; }
+
+        /**
+         * @brief Returns the flags that set layouts must be created with for their transient descriptors
+         * to use the descriptor buffer, or 0 if descriptor buffers are not used.
+        */
+        VkDescriptorSetLayoutCreateFlags transient_descriptor_set_layout_flags() const;
+
+        /**
+         * @brief Returns the flags that pipelines using layouts created with `transient_descriptor_set_layout_flags`
+         * must be created with, or 0 if descriptor buffers are not used.
+        */
+        VkPipelineCreateFlags transient_pipeline_create_flags() const;
+
+        /**
+         * @brief Returns the size of a uniform or storage buffer created by this context while descriptor buffers
+         * are used, otherwise 0. Used to resolve `VK_WHOLE_SIZE` ranges of descriptor buffer descriptors.
+         * @details Buffers are forgotten once destroyed or zombified.
+        */
+        VkDeviceSize descriptor_buffer_range_size(VkBuffer buffer) const;
         inline VkInstance instance() const { return m_instance; }
         inline VkSurfaceKHR surface() const { return m_surface; }
-        inline VkFence frame_fence() const { return m_frame_fences[m_current_frame_in_flight]; }
+        inline bool is_headless() const { return m_surface == nullptr; }
+        inline uint64_t frame_value() const { return m_frame_value; }
         inline Profile profile() const { return m_profile; }
         inline uint32_t current_frame_in_flight() const { return m_current_frame_in_flight; }
+        inline uint32_t max_frames_in_flight() const { return m_max_frames_in_flight; }
+        inline bool is_low_latency() const { return m_low_latency; }
+
+        /**
+         * @brief Returns whether push layouts and `Compute_command_buffer::push_descriptor_set` can be used.
+        */
+        inline bool is_push_descriptor_supported() const { return m_push_descriptor_supported; }
+
+    private:
+        void release_bindless_indices(const Image& image) const;
+        void release_bindless_indices(const Buffer& buffer) const;
+        void release_descriptor_buffer_range_sizes(const Buffer& buffer) const;
+        void flush_bindless_writes() const;
 
     private:
         const Window_system_integration& m_wsi;
@@ -229,8 +603,26 @@ namespace ygg::vk
         VmaAllocator m_allocator = nullptr;
         uint32_t m_current_frame_in_flight = 0;
         uint32_t m_max_frames_in_flight = 2;
-        Profile m_profile;
+        bool m_low_latency = false;
+        bool m_push_descriptor_supported = false;
+        Profile m_profile = Profile::Tier_1;
         std::vector<std::unique_ptr<Frame_context>> m_frame_contexts = {};
-        std::array<VkFence, YGG_MAX_FRAMES_IN_FLIGHT> m_frame_fences = {};
+        std::unique_ptr<Deferred_destruction_queue> m_deferred_destruction_queue = nullptr;
+        std::unique_ptr<Pipeline_cache> m_pipeline_cache = nullptr;
+        std::unique_ptr<Layout_cache> m_layout_cache = nullptr;
+        std::unique_ptr<Bindless_descriptor_heap> m_bindless_heap = nullptr;
+        std::optional<Descriptor_buffer_properties> m_descriptor_buffer_properties = std::nullopt;
+        VkDeviceSize m_transient_descriptor_buffer_size = 0;
+        mutable std::unordered_map<VkBuffer, VkDeviceSize> m_descriptor_buffer_range_sizes = {};
+        std::unique_ptr<Pipeline_library_cache> m_pipeline_library_cache = nullptr;
+        std::unique_ptr<Pipeline_state_cache> m_pipeline_state_cache = nullptr;
+        std::unique_ptr<Pipeline_compiler> m_pipeline_compiler = nullptr;
+        VkSemaphore m_frame_timeline = nullptr;
+        uint64_t m_frame_value = 0;
+        bool m_frame_completion_signaled = true;
+        std::array<uint64_t, YGG_MAX_FRAMES_IN_FLIGHT> m_frame_values = {};
+        VkSemaphore m_compute_timeline = nullptr;
+        uint64_t m_compute_value = 0;
+        std::array<uint64_t, YGG_MAX_FRAMES_IN_FLIGHT> m_frame_compute_values = {};
     };
 }
@@ -0,0 +1,126 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/vulkan/deferred_destruction_queue.h"
+
+#include <volk.h>
+
+namespace ygg::vk
+{
+    Deferred_destruction_queue::Deferred_destruction_queue(VkDevice device, VmaAllocator allocator,
+        uint32_t max_frames_in_flight)
+        : m_device(device), m_allocator(allocator), m_max_frames_in_flight(max_frames_in_flight)
+    {}
+
+    Deferred_destruction_queue::~Deferred_destruction_queue()
+    {
+        drain_all();
+    }
+
+    void Deferred_destruction_queue::push_buffer(const Buffer& buffer, uint64_t value)
+    {
+        m_buffers.push_back({ value, buffer });
+    }
+
+    void Deferred_destruction_queue::push_image(const Image& image, uint64_t value)
+    {
+        m_images.push_back({ value, image });
+    }
+
+    void Deferred_destruction_queue::push_image_view(VkImageView view, uint64_t value)
+    {
+        m_image_views.push_back({ value, view });
+    }
+
+    void Deferred_destruction_queue::push_pipeline(const Pipeline& pipeline, uint64_t value)
+    {
+        m_pipelines.push_back({ value, pipeline });
+    }
+
+    void Deferred_destruction_queue::push_pipeline_layout(VkPipelineLayout layout, uint64_t value)
+    {
+        m_pipeline_layouts.push_back({ value, layout });
+    }
+
+    void Deferred_destruction_queue::push_descriptor_set_layout(VkDescriptorSetLayout layout, uint64_t value)
+    {
+        m_descriptor_set_layouts.push_back({ value, layout });
+    }
+
+    void Deferred_destruction_queue::push_descriptor_pool(VkDescriptorPool pool, uint64_t value)
+    {
+        m_descriptor_pools.push_back({ value, pool });
+    }
+
+    void Deferred_destruction_queue::push_shader_module(const Shader_module& shader, uint64_t value)
+    {
+        m_shader_modules.push_back({ value, shader });
+    }
+
+    void Deferred_destruction_queue::push_semaphore(VkSemaphore semaphore, uint64_t value)
+    {
+        m_semaphores.push_back({ value, semaphore });
+    }
+
+    void Deferred_destruction_queue::push_fence(VkFence fence, uint64_t value)
+    {
+        m_fences.push_back({ value, fence });
+    }
+
+    template<typename T, typename Fn>
+    void Deferred_destruction_queue::drain_entries(std::vector<Entry<T>>& entries, uint64_t completed_value, Fn&& destroy)
+    {
+        std::size_t count = 0;
+        while (count < entries.size() && entries[count].value <= completed_value) {
+            destroy(entries[count].resource);
+            count++;
+        }
+        entries.erase(entries.begin(), entries.begin() + count);
+    }
+
+    void Deferred_destruction_queue::drain(uint64_t completed_value)
+    {
+        // Views and pipelines are destroyed before the resources they may reference.
+        drain_entries(m_image_views, completed_value, [this](VkImageView view) {
+            vkDestroyImageView(m_device, view, nullptr);
+        });
+        drain_entries(m_pipelines, completed_value, [this](Pipeline& pipeline) {
+            destroy_pipeline(m_device, pipeline);
+        });
+        drain_entries(m_shader_modules, completed_value, [this](Shader_module& shader) {
+            destroy_shader_module(m_device, shader);
+        });
+        drain_entries(m_pipeline_layouts, completed_value, [this](VkPipelineLayout layout) {
+            vkDestroyPipelineLayout(m_device, layout, nullptr);
+        });
+        drain_entries(m_descriptor_pools, completed_value, [this](VkDescriptorPool pool) {
+            vkDestroyDescriptorPool(m_device, pool, nullptr);
+        });
+        drain_entries(m_descriptor_set_layouts, completed_value, [this](VkDescriptorSetLayout layout) {
+            vkDestroyDescriptorSetLayout(m_device, layout, nullptr);
+        });
+        drain_entries(m_images, completed_value, [this](Image& image) {
+            destroy_image(image, m_allocator, m_device);
+        });
+        drain_entries(m_buffers, completed_value, [this](Buffer& buffer) {
+            destroy_buffer(buffer, m_allocator, m_max_frames_in_flight);
+        });
+        drain_entries(m_semaphores, completed_value, [this](VkSemaphore semaphore) {
+            vkDestroySemaphore(m_device, semaphore, nullptr);
+        });
+        drain_entries(m_fences, completed_value, [this](VkFence fence) {
+            vkDestroyFence(m_device, fence, nullptr);
+        });
+    }
+
+    void Deferred_destruction_queue::drain_all()
+    {
+        drain(~0ull);
+    }
+
+    std::size_t Deferred_destruction_queue::size() const
+    {
+        return m_buffers.size() + m_images.size() + m_image_views.size() + m_pipelines.size() +
+            m_pipeline_layouts.size() + m_descriptor_set_layouts.size() + m_descriptor_pools.size() +
+            m_shader_modules.size() + m_semaphores.size() + m_fences.size();
+    }
+}
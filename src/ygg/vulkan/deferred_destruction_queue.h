@@ -0,0 +1,84 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include "ygg/vulkan/resource.h"
+#include "ygg/vulkan/vk_forward_decl.h"
+
+#include <vector>
+
+namespace ygg::vk
+{
+    /**
+     * @brief Queue of resources that are destroyed once the GPU no longer uses them.
+     * @details Every resource is pushed together with a timeline value. `drain` destroys all resources
+     * whose value was reached, so resources can be released without waiting for the device to idle.
+     * Values must be pushed in non-decreasing order, which allows draining without searching.
+    */
+    class Deferred_destruction_queue
+    {
+    public:
+        /**
+         * @brief Creates a `Deferred_destruction_queue` instance destroying resources of the given device.
+         * @param max_frames_in_flight Used to destroy buffers, must match the one used when creating them.
+        */
+        Deferred_destruction_queue(VkDevice device, VmaAllocator allocator, uint32_t max_frames_in_flight);
+        ~Deferred_destruction_queue();
+
+        Deferred_destruction_queue(const Deferred_destruction_queue& other) = delete;
+        Deferred_destruction_queue& operator=(const Deferred_destruction_queue& other) = delete;
+
+        void push_buffer(const Buffer& buffer, uint64_t value);
+        void push_image(const Image& image, uint64_t value);
+        void push_image_view(VkImageView view, uint64_t value);
+        void push_pipeline(const Pipeline& pipeline, uint64_t value);
+        void push_pipeline_layout(VkPipelineLayout layout, uint64_t value);
+        void push_descriptor_set_layout(VkDescriptorSetLayout layout, uint64_t value);
+        void push_descriptor_pool(VkDescriptorPool pool, uint64_t value);
+        void push_shader_module(const Shader_module& shader, uint64_t value);
+        void push_semaphore(VkSemaphore semaphore, uint64_t value);
+        void push_fence(VkFence fence, uint64_t value);
+
+        /**
+         * @brief Destroys all resources pushed with a value less than or equal to `completed_value`.
+        */
+        void drain(uint64_t completed_value);
+
+        /**
+         * @brief Destroys all resources. The device must not use any of them anymore.
+        */
+        void drain_all();
+
+        /**
+         * @brief Returns the amount of resources waiting for destruction.
+        */
+        std::size_t size() const;
+
+    private:
+        template<typename T>
+        struct Entry
+        {
+            uint64_t value;
+            T resource;
+        };
+
+        template<typename T, typename Fn>
+        static void drain_entries(std::vector<Entry<T>>& entries, uint64_t completed_value, Fn&& destroy);
+
+    private:
+        VkDevice m_device;
+        VmaAllocator m_allocator;
+        uint32_t m_max_frames_in_flight;
+
+        std::vector<Entry<Buffer>> m_buffers = {};
+        std::vector<Entry<Image>> m_images = {};
+        std::vector<Entry<VkImageView>> m_image_views = {};
+        std::vector<Entry<Pipeline>> m_pipelines = {};
+        std::vector<Entry<VkPipelineLayout>> m_pipeline_layouts = {};
+        std::vector<Entry<VkDescriptorSetLayout>> m_descriptor_set_layouts = {};
+        std::vector<Entry<VkDescriptorPool>> m_descriptor_pools = {};
+        std::vector<Entry<Shader_module>> m_shader_modules = {};
+        std::vector<Entry<VkSemaphore>> m_semaphores = {};
+        std::vector<Entry<VkFence>> m_fences = {};
+    };
+}
@@ -0,0 +1,296 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/vulkan/descriptor_buffer.h"
+
+#include "ygg/vulkan/context.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vk_mem_alloc.h>
+#include <volk.h>
+
+namespace ygg::vk
+{
+    Descriptor_buffer_properties query_descriptor_buffer_properties(VkPhysicalDevice physical_device)
+    {
+        VkPhysicalDeviceDescriptorBufferPropertiesEXT descriptor_buffer_properties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT,
+            .pNext = nullptr
+        };
+        VkPhysicalDeviceProperties2 properties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+            .pNext = &descriptor_buffer_properties
+        };
+        vkGetPhysicalDeviceProperties2(physical_device, &properties);
+        const auto& p = descriptor_buffer_properties;
+        // Descriptors are written from the host, so the non-robust sizes apply.
+        return {
+            .offset_alignment = p.descriptorBufferOffsetAlignment,
+            .address_space_size = std::min(p.samplerDescriptorBufferAddressSpaceSize,
+                p.resourceDescriptorBufferAddressSpaceSize),
+            .sampler_size = p.samplerDescriptorSize,
+            .combined_image_sampler_size = p.combinedImageSamplerDescriptorSize,
+            .sampled_image_size = p.sampledImageDescriptorSize,
+            .storage_image_size = p.storageImageDescriptorSize,
+            .uniform_texel_buffer_size = p.uniformTexelBufferDescriptorSize,
+            .storage_texel_buffer_size = p.storageTexelBufferDescriptorSize,
+            .uniform_buffer_size = p.uniformBufferDescriptorSize,
+            .storage_buffer_size = p.storageBufferDescriptorSize,
+            .input_attachment_size = p.inputAttachmentDescriptorSize,
+            .combined_image_sampler_single_array = p.combinedImageSamplerDescriptorSingleArray == VK_TRUE
+        };
+    }
+
+    bool is_transient_descriptor_buffer_type(VkDescriptorType type)
+    {
+        switch (type)
+        {
+        case VK_DESCRIPTOR_TYPE_SAMPLER:
+            ;
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+            ;
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+            ;
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+            ;
+        case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+            ;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            ;
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+            return true;
+        default:
+            // Texel buffers need a format and range instead of a view, acceleration structures an address.
+            return false;
+        }
+    }
+
+    // Upper bound of the descriptor sizes of all devices, used to split combined image samplers on the stack.
+    constexpr static std::size_t MAX_DESCRIPTOR_SIZE = 256;
+
+    Transient_descriptor_buffer::Transient_descriptor_buffer(const Context& context,
+        const Descriptor_buffer_properties& properties, VkDeviceSize size)
+        : m_context(context), m_device(context.device()), m_allocator(context.allocator()), m_properties(properties)
+    {
+        if (!m_properties.combined_image_sampler_single_array &&
+            m_properties.combined_image_sampler_size > MAX_DESCRIPTOR_SIZE) {
+            printf("Combined image sampler descriptors are too large to be split.\n"); // TODO: logging?
+            std::abort();
+        }
+        m_buffer.info = {
+            .domain = Buffer_domain::Host_write_combined,
+            .size = size,
+            .usage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT |
+                VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT |
+                VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+        };
+        // The buffer is only ever written by the host, so it needs no queue family ownership transfers.
+        VkBufferCreateInfo buffer_create_info = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .size = m_buffer.info.size,
+            .usage = m_buffer.info.usage,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = 0,
+            .pQueueFamilyIndices = nullptr
+        };
+        // Unlike the Host_write_combined domain, the memory must never fall back to a non-mappable type.
+        VmaAllocationCreateInfo allocation_create_info = {
+            .flags = VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+            .usage = VMA_MEMORY_USAGE_AUTO
+        };
+        auto& allocated_buffer = m_buffer.allocated_buffers[0];
+        VmaAllocationInfo allocation_info = {};
+        // The device address is the base of every bound offset, so it must satisfy the offset alignment as well.
+        // TODO: add VK_CHECK();
+        vmaCreateBufferWithAlignment(m_allocator, &buffer_create_info, &allocation_create_info,
+            m_properties.offset_alignment, &allocated_buffer.handle, &allocated_buffer.allocation, &allocation_info);
+        allocated_buffer.mapped_data = allocation_info.pMappedData;
+        m_mapped_data = static_cast<std::byte*>(allocated_buffer.mapped_data);
+
+        VkBufferDeviceAddressInfo address_info = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+            .pNext = nullptr,
+            .buffer = m_buffer.allocated_buffers[0].handle
+        };
+        m_device_address = vkGetBufferDeviceAddress(m_device, &address_info);
+    }
+
+    Transient_descriptor_buffer::~Transient_descriptor_buffer()
+    {
+        destroy_buffer(m_buffer, m_allocator, 1);
+    }
+
+    Descriptor_buffer_allocation Transient_descriptor_buffer::allocate(VkDescriptorSetLayout layout)
+    {
+        VkDeviceSize layout_size = 0;
+        vkGetDescriptorSetLayoutSizeEXT(m_device, layout, &layout_size);
+        const auto alignment = m_properties.offset_alignment;
+        VkDeviceSize offset = (m_offset + alignment - 1) / alignment * alignment;
+        if (offset + layout_size > m_buffer.info.size) {
+            printf("Transient descriptor buffer is full.\n"); // TODO: logging?
+            std::abort();
+        }
+        m_offset = offset + layout_size;
+        return { layout, offset, m_mapped_data + offset };
+    }
+
+    void Transient_descriptor_buffer::write(const Descriptor_buffer_allocation& allocation,
+        const Descriptor_set_write_info& write_info)
+    {
+        VkDeviceSize binding_offset = 0;
+        vkGetDescriptorSetLayoutBindingOffsetEXT(m_device, allocation.layout, write_info.binding, &binding_offset);
+        const auto size = descriptor_size(write_info.type);
+        std::byte* dst = allocation.data + binding_offset + write_info.array_index * size;
+
+        VkDescriptorGetInfoEXT get_info = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT,
+            .pNext = nullptr,
+            .type = write_info.type,
+            .data = {}
+        };
+        switch (write_info.type)
+        {
+        case VK_DESCRIPTOR_TYPE_SAMPLER:
+            for (const auto& image_info : write_info.image_infos) {
+                get_info.data.pSampler = &image_info.sampler;
+                vkGetDescriptorEXT(m_device, &get_info, size, dst);
+                dst += size;
+            }
+            break;
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+            if (!m_properties.combined_image_sampler_single_array) {
+                write_split_combined_image_samplers(allocation, write_info, binding_offset);
+                break;
+            }
+            [[fallthrough]];
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+            ;
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+            ;
+        case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+            for (const auto& image_info : write_info.image_infos) {
+                // All image members of VkDescriptorDataEXT are the same pointer type.
+                get_info.data.pSampledImage = reinterpret_cast<const VkDescriptorImageInfo*>(&image_info);
+                vkGetDescriptorEXT(m_device, &get_info, size, dst);
+                dst += size;
+            }
+            break;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            ;
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+            for (const auto& buffer_info : write_info.buffer_infos) {
+                VkDeviceSize range = buffer_info.range;
+                if (range == VK_WHOLE_SIZE) {
+                    VkDeviceSize buffer_size = m_context.descriptor_buffer_range_size(buffer_info.buffer);
+                    if (buffer_size == 0) {
+                        printf("VK_WHOLE_SIZE requires a buffer created by the Context.\n"); // TODO: logging?
+                        std::abort();
+                    }
+                    range = buffer_size - buffer_info.offset;
+                }
+                VkBufferDeviceAddressInfo buffer_address_info = {
+                    .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+                    .pNext = nullptr,
+                    .buffer = buffer_info.buffer
+                };
+                VkDescriptorAddressInfoEXT address_info = {
+                    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT,
+                    .pNext = nullptr,
+                    .address = vkGetBufferDeviceAddress(m_device, &buffer_address_info) + buffer_info.offset,
+                    .range = range,
+                    .format = VK_FORMAT_UNDEFINED
+                };
+                // All buffer members of VkDescriptorDataEXT are the same pointer type.
+                get_info.data.pStorageBuffer = &address_info;
+                vkGetDescriptorEXT(m_device, &get_info, size, dst);
+                dst += size;
+            }
+            break;
+        default:
+            // Layouts containing other types are rejected on creation, so the write doesn't match its layout.
+            assert(false && "Descriptor type not supported by transient descriptor buffers.");
+            break;
+        }
+    }
+
+    void Transient_descriptor_buffer::write_split_combined_image_samplers(const Descriptor_buffer_allocation& allocation,
+        const Descriptor_set_write_info& write_info, VkDeviceSize binding_offset)
+    {
+        // The binding is laid out as all of its image descriptors followed by all of its sampler descriptors.
+        uint32_t binding_count = 0;
+        for (const auto& binding : m_context.layout_cache().descriptor_set_layout_info(allocation.layout).bindings) {
+            if (binding.binding == write_info.binding) {
+                binding_count = binding.count;
+                break;
+            }
+        }
+        std::byte* images = allocation.data + binding_offset;
+        std::byte* samplers = images + binding_count * m_properties.sampled_image_size;
+
+        VkDescriptorGetInfoEXT get_info = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT,
+            .pNext = nullptr,
+            .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .data = {}
+        };
+        std::array<std::byte, MAX_DESCRIPTOR_SIZE> descriptor;
+        uint32_t array_index = write_info.array_index;
+        for (const auto& image_info : write_info.image_infos) {
+            get_info.data.pCombinedImageSampler = reinterpret_cast<const VkDescriptorImageInfo*>(&image_info);
+            vkGetDescriptorEXT(m_device, &get_info, m_properties.combined_image_sampler_size, descriptor.data());
+            // The returned descriptor is the image descriptor followed by the sampler descriptor.
+            memcpy(images + array_index * m_properties.sampled_image_size, descriptor.data(),
+                m_properties.sampled_image_size);
+            memcpy(samplers + array_index * m_properties.sampler_size,
+                descriptor.data() + m_properties.sampled_image_size, m_properties.sampler_size);
+            array_index++;
+        }
+    }
+
+    void Transient_descriptor_buffer::write(const Descriptor_buffer_allocation& allocation,
+        std::span<const Descriptor_set_write_info> write_infos)
+    {
+        for (const auto& write_info : write_infos) {
+            write(allocation, write_info);
+        }
+    }
+
+    void Transient_descriptor_buffer::reset()
+    {
+        m_offset = 0;
+    }
+
+    std::size_t Transient_descriptor_buffer::descriptor_size(VkDescriptorType type) const
+    {
+        switch (type)
+        {
+        case VK_DESCRIPTOR_TYPE_SAMPLER:
+            return m_properties.sampler_size;
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+            return m_properties.combined_image_sampler_size;
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+            return m_properties.sampled_image_size;
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+            return m_properties.storage_image_size;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+            return m_properties.uniform_texel_buffer_size;
+        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+            return m_properties.storage_texel_buffer_size;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            return m_properties.uniform_buffer_size;
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+            return m_properties.storage_buffer_size;
+        case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+            return m_properties.input_attachment_size;
+        default:
+            assert(false && "Descriptor type not supported by transient descriptor buffers.");
+            return 0;
+        }
+    }
+}
@@ -0,0 +1,120 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include "ygg/vulkan/descriptors.h"
+#include "ygg/vulkan/resource.h"
+#include "ygg/vulkan/vk_forward_decl.h"
+
+#include <cstddef>
+#include <span>
+
+namespace ygg::vk
+{
+    class Context;
+
+    /**
+     * @brief https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkPhysicalDeviceDescriptorBufferPropertiesEXT.html
+     * @details Only the properties required to write and bind descriptors.
+    */
+    struct Descriptor_buffer_properties
+    {
+        VkDeviceSize offset_alignment;
+        VkDeviceSize address_space_size; // Shared by all descriptor buffers holding samplers and resources.
+        std::size_t sampler_size;
+        std::size_t combined_image_sampler_size;
+        std::size_t sampled_image_size;
+        std::size_t storage_image_size;
+        std::size_t uniform_texel_buffer_size;
+        std::size_t storage_texel_buffer_size;
+        std::size_t uniform_buffer_size;
+        std::size_t storage_buffer_size;
+        std::size_t input_attachment_size;
+        bool combined_image_sampler_single_array; // Otherwise split into an image and a sampler array per binding.
+    };
+
+    /**
+     * @brief Queries the properties of a device supporting VK_EXT_descriptor_buffer.
+    */
+    Descriptor_buffer_properties query_descriptor_buffer_properties(VkPhysicalDevice physical_device);
+
+    /**
+     * @brief Returns whether descriptors of the type can be written by `Transient_descriptor_buffer`.
+    */
+    bool is_transient_descriptor_buffer_type(VkDescriptorType type);
+
+    /**
+     * @brief The memory of a single descriptor set inside of a descriptor buffer.
+    */
+    struct Descriptor_buffer_allocation
+    {
+        VkDescriptorSetLayout layout;
+        VkDeviceSize offset;
+        std::byte* data;
+    };
+
+    /**
+     * @brief Descriptor allocator used to allocate one-frame-use descriptors from a descriptor buffer.
+     * @details Allocating is a bump of an offset into a persistently mapped buffer and writing copies the
+     * descriptor data returned by `vkGetDescriptorEXT` into it, no pools or descriptor set objects are involved.
+     * The buffer never grows, allocating more than it can hold aborts.
+     * Only layouts created with `VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT` can be allocated,
+     * pipelines using them must be created with `VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT`.
+     * Dynamic buffers, texel buffers and acceleration structures are not supported, layouts containing them
+     * are rejected by `Context::create_descriptor_set_layout`.
+     * All functions must be externally synchronized.
+    */
+    class Transient_descriptor_buffer
+    {
+    public:
+        /**
+         * @param context Its allocator must be created with `VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT`.
+         * The layouts and buffers written to the descriptors must be created by it.
+        */
+        Transient_descriptor_buffer(const Context& context, const Descriptor_buffer_properties& properties,
+            VkDeviceSize size);
+        ~Transient_descriptor_buffer();
+
+        Transient_descriptor_buffer(const Transient_descriptor_buffer& other) = delete;
+        Transient_descriptor_buffer& operator=(const Transient_descriptor_buffer& other) = delete;
+
+        /**
+         * @brief Allocates the memory of a single descriptor set using the given layout.
+        */
+        Descriptor_buffer_allocation allocate(VkDescriptorSetLayout layout);
+
+        /**
+         * @brief Writes the descriptors into the allocation. `write_info.set` is ignored.
+         * @details The descriptors are visible to the device immediately, but must not be written while
+         * a submitted command buffer still uses them.
+         * Ranges of `VK_WHOLE_SIZE` are resolved against the size of the buffer.
+        */
+        void write(const Descriptor_buffer_allocation& allocation, const Descriptor_set_write_info& write_info);
+        void write(const Descriptor_buffer_allocation& allocation, std::span<const Descriptor_set_write_info> write_infos);
+
+        /**
+         * @brief Resets this allocator, invalidating all allocations made from this instance.
+        */
+        void reset();
+
+        inline VkDeviceAddress device_address() const { return m_device_address; }
+        inline VkBufferUsage usage() const { return m_buffer.info.usage; }
+        inline VkDeviceSize size() const { return m_buffer.info.size; }
+        inline VkDeviceSize used_size() const { return m_offset; }
+
+    private:
+        std::size_t descriptor_size(VkDescriptorType type) const;
+        void write_split_combined_image_samplers(const Descriptor_buffer_allocation& allocation,
+            const Descriptor_set_write_info& write_info, VkDeviceSize binding_offset);
+
+    private:
+        const Context& m_context;
+        VkDevice m_device;
+        VmaAllocator m_allocator;
+        Descriptor_buffer_properties m_properties;
+        Buffer m_buffer = {};
+        std::byte* m_mapped_data = nullptr;
+        VkDeviceAddress m_device_address = 0;
+        VkDeviceSize m_offset = 0;
+    };
+}
@@ -3,97 +3,245 @@
 #include "ygg/vulkan/descriptors.h"
 
 #include <array>
+#include <cassert>
+#include <cstddef>
 #include <volk.h>
 
 namespace ygg::vk
 {
+    // Descriptor update templates and push descriptors read the descriptor infos as Vulkan descriptor infos.
+    static_assert(sizeof(Descriptor_buffer_info) == sizeof(VkDescriptorBufferInfo)
+        && offsetof(Descriptor_buffer_info, buffer) == offsetof(VkDescriptorBufferInfo, buffer)
+        && offsetof(Descriptor_buffer_info, offset) == offsetof(VkDescriptorBufferInfo, offset)
+        && offsetof(Descriptor_buffer_info, range) == offsetof(VkDescriptorBufferInfo, range));
+    static_assert(sizeof(Descriptor_image_info) == sizeof(VkDescriptorImageInfo)
+        && offsetof(Descriptor_image_info, sampler) == offsetof(VkDescriptorImageInfo, sampler)
+        && offsetof(Descriptor_image_info, view) == offsetof(VkDescriptorImageInfo, imageView)
+        && offsetof(Descriptor_image_info, layout) == offsetof(VkDescriptorImageInfo, imageLayout));
+    static_assert(sizeof(Descriptor_texel_buffer_view_info) == sizeof(VkBufferView));
+    static_assert(sizeof(Descriptor_acceleration_structure_info) == sizeof(VkAccelerationStructureKHR));
+
     void update_descriptor_set(VkDevice device, const Descriptor_set_write_info& write_info)
     {
-        auto arr = std::to_array<Descriptor_set_write_info>({ write_info });
-        update_descriptor_sets(device, { arr });
-    }
-
-    void update_descriptor_sets(VkDevice device, std::span<Descriptor_set_write_info> write_infos)
-    {
-        std::vector<std::vector<VkDescriptorBufferInfo>> buffer_infos;
-        buffer_infos.reserve(write_infos.size());
-        std::vector<std::vector<VkDescriptorImageInfo>> image_infos;
-        image_infos.reserve(write_infos.size());
-        std::vector<std::vector<VkBufferView>> buffer_views;
-        buffer_views.reserve(write_infos.size());
-
-        std::vector<VkWriteDescriptorSet> writes;
-        writes.reserve(write_infos.size());
-        for (const auto& wi : write_infos) {
-            auto& write_buffer_infos = buffer_infos.emplace_back();
-            auto& write_image_infos = image_infos.emplace_back();
-            auto& write_buffer_views = buffer_views.emplace_back();
-            VkWriteDescriptorSet write {
-                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    .pNext = nullptr,
-                    .dstSet = wi.set,
-                    .dstBinding = wi.binding,
-                    .dstArrayElement = wi.array_index,
-                    .descriptorType = wi.type
-            };
-            uint32_t count = 0;
-            switch (wi.type)
-            {
-            default: break;
-            case VK_DESCRIPTOR_TYPE_SAMPLER:
-                ;
-            case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
-                ;
-            case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
-                ;
-            case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
-                write_image_infos.reserve(wi.image_infos.size());
-                for (const auto& img_info : wi.image_infos) {
-                    write_image_infos.emplace_back( VkDescriptorImageInfo {
-                            .sampler = img_info.sampler,
-                            .imageView = img_info.view,
-                            .imageLayout = img_info.layout
-                        });
-                }
-                count = uint32_t(wi.image_infos.size());
-                write.pImageInfo = write_image_infos.data();
-                break;
-            case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
-                ;
-            case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
-                write_buffer_views.reserve(wi.texel_buffer_view_infos.size());
-                for (const auto& buffer_view : wi.texel_buffer_view_infos) {
-                    write_buffer_views.emplace_back( buffer_view.buffer_view );
-                }
-                count = uint32_t(wi.texel_buffer_view_infos.size());
-                write.pTexelBufferView = write_buffer_views.data();
-                break;
-            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
-                ;
-            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
-                ;
-            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
-                ;
-            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
-                write_buffer_infos.reserve(wi.buffer_infos.size());
-                for (const auto& buffer_info : wi.buffer_infos) {
-                    write_buffer_infos.emplace_back( VkDescriptorBufferInfo {
-                            .buffer = buffer_info.buffer,
-                            .offset = buffer_info.offset,
-                            .range = buffer_info.range
-                        });
-                }
-                count = uint32_t(wi.buffer_infos.size());
-                write.pBufferInfo = write_buffer_infos.data();
-                break;
-            case VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR:
-                // TODO: implement acceleration structure updating.
-                break;
+        update_descriptor_sets(device, { &write_info, 1 });
+    }
+
+    enum class Descriptor_write_storage
+    {
+        None,
+        Buffer_info,
+        Image_info,
+        Texel_buffer_view
+    };
+
+    Descriptor_write_storage descriptor_write_storage(VkDescriptorType type)
+    {
+        switch (type)
+        {
+        case VK_DESCRIPTOR_TYPE_SAMPLER:
+            ;
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+            ;
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+            ;
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+            return Descriptor_write_storage::Image_info;
+        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+            ;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+            return Descriptor_write_storage::Texel_buffer_view;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            ;
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+            ;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+            ;
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+            return Descriptor_write_storage::Buffer_info;
+        case VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR:
+            // TODO: implement acceleration structure updating.
+            ;
+        default:
+            return Descriptor_write_storage::None;
+        }
+    }
+
+    void translate_descriptor_set_write(const Descriptor_set_write_info& write_info, VkWriteDescriptorSet& result)
+    {
+        result = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = nullptr,
+            .dstSet = write_info.set,
+            .dstBinding = write_info.binding,
+            .dstArrayElement = write_info.array_index,
+            .descriptorCount = 0,
+            .descriptorType = write_info.type,
+            .pImageInfo = nullptr,
+            .pBufferInfo = nullptr,
+            .pTexelBufferView = nullptr
+        };
+        // The descriptor infos match the Vulkan layouts, so they can be referenced in place.
+        switch (descriptor_write_storage(write_info.type))
+        {
+        case Descriptor_write_storage::Buffer_info:
+            result.descriptorCount = uint32_t(write_info.buffer_infos.size());
+            result.pBufferInfo = reinterpret_cast<const VkDescriptorBufferInfo*>(write_info.buffer_infos.data());
+            break;
+        case Descriptor_write_storage::Image_info:
+            result.descriptorCount = uint32_t(write_info.image_infos.size());
+            result.pImageInfo = reinterpret_cast<const VkDescriptorImageInfo*>(write_info.image_infos.data());
+            break;
+        case Descriptor_write_storage::Texel_buffer_view:
+            result.descriptorCount = uint32_t(write_info.texel_buffer_view_infos.size());
+            result.pTexelBufferView = reinterpret_cast<const VkBufferView*>(write_info.texel_buffer_view_infos.data());
+            break;
+        case Descriptor_write_storage::None:
+            break;
+        }
+    }
+
+    void update_descriptor_sets(VkDevice device, std::span<const Descriptor_set_write_info> write_infos)
+    {
+        // The writes reference the infos in place, so updating needs no copies or heap allocations.
+        constexpr std::size_t MAX_WRITES_PER_UPDATE = 64;
+        std::array<VkWriteDescriptorSet, MAX_WRITES_PER_UPDATE> writes;
+        uint32_t write_count = 0;
+        for (const auto& write_info : write_infos) {
+            translate_descriptor_set_write(write_info, writes[write_count]);
+            if (writes[write_count].descriptorCount == 0) {
+                continue;
             }
-            write.descriptorCount = count;
-            writes.emplace_back( write );
+            if (++write_count == writes.size()) {
+                vkUpdateDescriptorSets(device, write_count, writes.data(), 0, nullptr);
+                write_count = 0;
+            }
+        }
+        if (write_count > 0) {
+            vkUpdateDescriptorSets(device, write_count, writes.data(), 0, nullptr);
         }
-        vkUpdateDescriptorSets(device, uint32_t(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    Descriptor_write_batcher::Descriptor_write_batcher(VkDevice device, const Descriptor_write_batcher_info& info)
+        : m_device(device), m_writes(info.max_writes), m_buffer_infos(info.max_buffer_infos),
+        m_image_infos(info.max_image_infos), m_texel_buffer_views(info.max_texel_buffer_views)
+    {}
+
+    Descriptor_write_batcher::~Descriptor_write_batcher()
+    {}
+
+    void Descriptor_write_batcher::push(const Descriptor_set_write_info& write_info)
+    {
+        auto storage = descriptor_write_storage(write_info.type);
+        uint32_t count = 0;
+        uint32_t* used = nullptr;
+        std::size_t capacity = 0;
+        switch (storage)
+        {
+        case Descriptor_write_storage::Buffer_info:
+            count = uint32_t(write_info.buffer_infos.size());
+            used = &m_buffer_info_count;
+            capacity = m_buffer_infos.size();
+            break;
+        case Descriptor_write_storage::Image_info:
+            count = uint32_t(write_info.image_infos.size());
+            used = &m_image_info_count;
+            capacity = m_image_infos.size();
+            break;
+        case Descriptor_write_storage::Texel_buffer_view:
+            count = uint32_t(write_info.texel_buffer_view_infos.size());
+            used = &m_texel_buffer_view_count;
+            capacity = m_texel_buffer_views.size();
+            break;
+        case Descriptor_write_storage::None:
+            return;
+        }
+        if (count == 0) {
+            return;
+        }
+        if (m_writes.empty() || count > capacity) {
+            // Can never fit into the arenas, update it on its own instead.
+            VkWriteDescriptorSet write;
+            translate_descriptor_set_write(write_info, write);
+            vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+            m_statistics.writes++;
+            return;
+        }
+        if (m_write_count == m_writes.size() || *used + count > capacity) {
+            // The arenas never grow so the pending info pointers stay valid, submit them instead.
+            flush();
+            m_statistics.overflow_flushes++;
+        }
+
+        VkWriteDescriptorSet& write = m_writes[m_write_count++];
+        write = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = nullptr,
+            .dstSet = write_info.set,
+            .dstBinding = write_info.binding,
+            .dstArrayElement = write_info.array_index,
+            .descriptorCount = count,
+            .descriptorType = write_info.type,
+            .pImageInfo = nullptr,
+            .pBufferInfo = nullptr,
+            .pTexelBufferView = nullptr
+        };
+        switch (storage)
+        {
+        case Descriptor_write_storage::Buffer_info:
+            write.pBufferInfo = &m_buffer_infos[m_buffer_info_count];
+            for (const auto& buffer_info : write_info.buffer_infos) {
+                m_buffer_infos[m_buffer_info_count++] = {
+                    .buffer = buffer_info.buffer,
+                    .offset = buffer_info.offset,
+                    .range = buffer_info.range
+                };
+            }
+            break;
+        case Descriptor_write_storage::Image_info:
+            write.pImageInfo = &m_image_infos[m_image_info_count];
+            for (const auto& img_info : write_info.image_infos) {
+                m_image_infos[m_image_info_count++] = {
+                    .sampler = img_info.sampler,
+                    .imageView = img_info.view,
+                    .imageLayout = img_info.layout
+                };
+            }
+            break;
+        case Descriptor_write_storage::Texel_buffer_view:
+            write.pTexelBufferView = &m_texel_buffer_views[m_texel_buffer_view_count];
+            for (const auto& buffer_view : write_info.texel_buffer_view_infos) {
+                m_texel_buffer_views[m_texel_buffer_view_count++] = buffer_view.buffer_view;
+            }
+            break;
+        case Descriptor_write_storage::None:
+            break;
+        }
+        m_statistics.writes++;
+    }
+
+    void Descriptor_write_batcher::push(std::span<const Descriptor_set_write_info> write_infos)
+    {
+        for (const auto& write_info : write_infos) {
+            push(write_info);
+        }
+    }
+
+    void Descriptor_write_batcher::flush()
+    {
+        if (m_write_count == 0) {
+            return;
+        }
+        vkUpdateDescriptorSets(m_device, m_write_count, m_writes.data(), 0, nullptr);
+        m_statistics.flushes++;
+        m_write_count = 0;
+        m_buffer_info_count = 0;
+        m_image_info_count = 0;
+        m_texel_buffer_view_count = 0;
+    }
+
+    void Descriptor_write_batcher::reset_statistics()
+    {
+        m_statistics = {};
     }
 
     VkDescriptorSetLayout create_descriptor_set_layout(VkDevice device, const Descriptor_set_layout_info& info)
@@ -124,7 +272,7 @@ namespace ygg::vk
 
         VkDescriptorSetLayoutCreateInfo create_info = {
             .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-            .pNext = nullptr,
+            .pNext = &flags_info,
             .flags = info.flags,
             .bindingCount = uint32_t(bindings.size()),
             .pBindings = bindings.data()
@@ -136,6 +284,103 @@ namespace ygg::vk
         return result;
     }
 
+    std::size_t descriptor_info_size(VkDescriptorType type)
+    {
+        switch (type)
+        {
+        case VK_DESCRIPTOR_TYPE_SAMPLER:
+            ;
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+            ;
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+            ;
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+            ;
+        case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+            return sizeof(Descriptor_image_info);
+        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+            ;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+            return sizeof(Descriptor_texel_buffer_view_info);
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            ;
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+            ;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+            ;
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+            return sizeof(Descriptor_buffer_info);
+        case VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR:
+            return sizeof(Descriptor_acceleration_structure_info);
+        default:
+            assert(false && "Descriptor type is not supported by descriptor update templates.");
+            return 0;
+        }
+    }
+
+    std::vector<Descriptor_update_template_entry> descriptor_update_template_entries(
+        const Descriptor_set_layout_info& info)
+    {
+        std::vector<Descriptor_update_template_entry> result = {};
+        result.reserve(info.bindings.size());
+        std::size_t offset = 0;
+        for (const auto& b : info.bindings) {
+            if (b.count == 0) {
+                continue;
+            }
+            auto stride = descriptor_info_size(b.type);
+            result.emplace_back( Descriptor_update_template_entry {
+                    .binding = b.binding,
+                    .array_index = 0,
+                    .count = b.count,
+                    .type = b.type,
+                    .offset = offset,
+                    .stride = stride
+                });
+            offset += stride * b.count;
+        }
+        return result;
+    }
+
+    VkDescriptorUpdateTemplate create_descriptor_update_template(VkDevice device,
+        const Descriptor_update_template_info& info)
+    {
+        std::vector<VkDescriptorUpdateTemplateEntry> entries = {};
+        entries.reserve(info.entries.size());
+        for (const auto& e : info.entries) {
+            entries.emplace_back( VkDescriptorUpdateTemplateEntry {
+                    .dstBinding = e.binding,
+                    .dstArrayElement = e.array_index,
+                    .descriptorCount = e.count,
+                    .descriptorType = e.type,
+                    .offset = e.offset,
+                    .stride = e.stride
+                });
+        }
+        VkDescriptorUpdateTemplateCreateInfo create_info = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .descriptorUpdateEntryCount = uint32_t(entries.size()),
+            .pDescriptorUpdateEntries = entries.data(),
+            .templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET,
+            .descriptorSetLayout = info.layout,
+            .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+            .pipelineLayout = VK_NULL_HANDLE,
+            .set = 0
+        };
+        VkDescriptorUpdateTemplate result = VK_NULL_HANDLE;
+        // TODO: VK_CHECK
+        vkCreateDescriptorUpdateTemplate(device, &create_info, nullptr, &result);
+        return result;
+    }
+
+    void update_descriptor_set_with_template(VkDevice device, VkDescriptorSet set,
+        VkDescriptorUpdateTemplate update_template, const void* data)
+    {
+        vkUpdateDescriptorSetWithTemplate(device, set, update_template, data);
+    }
+
     std::vector<VkDescriptorPoolSize> pool_sizes(const std::span<Descriptor_pool_size>& sizes)
     {
         std::vector<VkDescriptorPoolSize> result;
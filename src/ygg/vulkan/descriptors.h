@@ -67,7 +67,81 @@ namespace ygg::vk
      * @brief https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/vkUpdateDescriptorSets.html
     */
     void update_descriptor_set(VkDevice device, const Descriptor_set_write_info& write_info);
-    void update_descriptor_sets(VkDevice device, std::span<Descriptor_set_write_info> write_infos);
+    void update_descriptor_sets(VkDevice device, std::span<const Descriptor_set_write_info> write_infos);
+
+    /**
+     * @brief Translates the write without copying its infos, which must outlive the translated write.
+     * @details Used where the write is consumed immediately, e.g. by push descriptors.
+    */
+    void translate_descriptor_set_write(const Descriptor_set_write_info& write_info, VkWriteDescriptorSet& result);
+
+    /**
+     * @brief Capacities of a Descriptor_write_batcher. All storage is allocated once on construction.
+    */
+    struct Descriptor_write_batcher_info
+    {
+        uint32_t max_writes = 1024;
+        uint32_t max_buffer_infos = 1024;
+        uint32_t max_image_infos = 1024;
+        uint32_t max_texel_buffer_views = 256;
+    };
+
+    struct Descriptor_write_batcher_statistics
+    {
+        uint32_t writes;
+        uint32_t flushes;
+        uint32_t overflow_flushes;
+    };
+
+    /**
+     * @brief Accumulates descriptor writes and submits them with a single `vkUpdateDescriptorSets` call.
+     * @details Pushed writes and their infos are copied into arenas that are allocated once and reused after
+     * every flush, so batching writes performs no heap allocations. The arenas never grow, which keeps the
+     * info pointers of all pending writes valid. If a write does not fit, the pending writes are flushed early.
+     * Writes are only visible to the device once flushed, so a batch must be flushed before any of the
+     * written sets is bound. Pending writes are discarded on destruction.
+     * All functions must be externally synchronized.
+    */
+    class Descriptor_write_batcher
+    {
+    public:
+        Descriptor_write_batcher(VkDevice device, const Descriptor_write_batcher_info& info = {});
+        ~Descriptor_write_batcher();
+
+        Descriptor_write_batcher(const Descriptor_write_batcher& other) = delete;
+        Descriptor_write_batcher& operator=(const Descriptor_write_batcher& other) = delete;
+
+        /**
+         * @brief Copies the write and its infos into the batch. The passed infos may be freed afterwards.
+        */
+        void push(const Descriptor_set_write_info& write_info);
+        void push(std::span<const Descriptor_set_write_info> write_infos);
+
+        /**
+         * @brief Updates all pending writes and empties the batch. Does nothing if the batch is empty.
+        */
+        void flush();
+
+        uint32_t pending_write_count() const { return m_write_count; }
+
+        /**
+         * @brief Returns the statistics since the last call to `reset_statistics`.
+        */
+        const Descriptor_write_batcher_statistics& statistics() const { return m_statistics; }
+        void reset_statistics();
+
+    private:
+        VkDevice m_device;
+        std::vector<VkWriteDescriptorSet> m_writes;
+        std::vector<VkDescriptorBufferInfo> m_buffer_infos;
+        std::vector<VkDescriptorImageInfo> m_image_infos;
+        std::vector<VkBufferView> m_texel_buffer_views;
+        uint32_t m_write_count = 0;
+        uint32_t m_buffer_info_count = 0;
+        uint32_t m_image_info_count = 0;
+        uint32_t m_texel_buffer_view_count = 0;
+        Descriptor_write_batcher_statistics m_statistics = {};
+    };
 
     /**
      * @brief Combination of VkDescriptorSetLayoutBinding and an inlined
@@ -85,6 +159,8 @@ namespace ygg::vk
 
     /**
      * @brief https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkDescriptorSetLayoutCreateInfo.html
+     * @details Layouts created with `VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR` are push layouts.
+     * No sets are allocated for them, their descriptors are recorded with `Compute_command_buffer::push_descriptor_set`.
     */
     struct Descriptor_set_layout_info
     {
@@ -97,6 +173,52 @@ namespace ygg::vk
     */
     VkDescriptorSetLayout create_descriptor_set_layout(VkDevice device, const Descriptor_set_layout_info& info);
 
+    /**
+     * @brief https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkDescriptorUpdateTemplateEntry.html
+     * @details `offset` and `stride` locate the descriptors in the raw data passed to
+     * `update_descriptor_set_with_template`. The descriptor info structs above match the layout the device
+     * reads, so the data can be a plain struct of them.
+    */
+    struct Descriptor_update_template_entry
+    {
+        uint32_t binding;
+        uint32_t array_index;
+        uint32_t count;
+        VkDescriptorType type;
+        std::size_t offset;
+        std::size_t stride;
+    };
+
+    /**
+     * @brief https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkDescriptorUpdateTemplateCreateInfo.html
+    */
+    struct Descriptor_update_template_info
+    {
+        VkDescriptorSetLayout layout;
+        std::vector<Descriptor_update_template_entry> entries;
+    };
+
+    /**
+     * @brief Returns the template entries for a struct declaring every binding of the layout in order,
+     * each as `count` consecutive descriptor infos of the type matching the binding.
+     * @details All descriptor infos are 8 byte aligned with a size that is a multiple of 8,
+     * so such a struct never contains padding.
+    */
+    std::vector<Descriptor_update_template_entry> descriptor_update_template_entries(
+        const Descriptor_set_layout_info& info);
+
+    /**
+     * @brief https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/vkCreateDescriptorUpdateTemplate.html
+    */
+    VkDescriptorUpdateTemplate create_descriptor_update_template(VkDevice device,
+        const Descriptor_update_template_info& info);
+
+    /**
+     * @brief https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/vkUpdateDescriptorSetWithTemplate.html
+    */
+    void update_descriptor_set_with_template(VkDevice device, VkDescriptorSet set,
+        VkDescriptorUpdateTemplate update_template, const void* data);
+
     /**
      * @brief https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkDescriptorPoolSize.html
     */
@@ -0,0 +1,37 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/vulkan/glsl_batch_compiler.h"
+
+namespace ygg::vk::glsl_compiler
+{
+    Batch_compiler::Process_reference::Process_reference()
+    {
+        init();
+    }
+
+    Batch_compiler::Process_reference::~Process_reference()
+    {
+        deinit();
+    }
+
+    Batch_compiler::Batch_compiler(uint32_t thread_count)
+        : m_process_reference(), m_thread_pool(thread_count)
+    {}
+
+    std::future<Compile_result> Batch_compiler::compile(Compile_job job)
+    {
+        return m_thread_pool.submit([job = std::move(job)]() {
+            return compile_spirv_1_6(job.code, job.shader_stage, job.include_dirs, job.defines);
+        });
+    }
+
+    std::vector<std::future<Compile_result>> Batch_compiler::compile(std::span<const Compile_job> jobs)
+    {
+        std::vector<std::future<Compile_result>> results = {};
+        results.reserve(jobs.size());
+        for (const auto& job : jobs) {
+            results.push_back(compile(job));
+        }
+        return results;
+    }
+}
@@ -0,0 +1,71 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include "ygg/thread/thread_pool.h"
+#include "ygg/vulkan/glsl_compiler.h"
+#include "ygg/vulkan/vk_forward_decl.h"
+
+#include <future>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace ygg::vk::glsl_compiler
+{
+    struct Compile_job
+    {
+        std::string code;
+        VkShaderStageFlags shader_stage;
+        std::vector<std::string> include_dirs = {};
+        std::vector<Shader_define> defines = {};
+    };
+
+    /**
+     * @brief Compiles many shaders concurrently on a thread pool.
+     * @details The glslang process state is initialized while an instance exists, `init()` and `deinit()`
+     * are reference counted by glslang, so this does not interfere with other users of the compiler.
+     * Every job creates its own glslang shader and program on the worker thread, which binds glslang's
+     * per-thread pool allocator to that job. The jobs are copied, the sources don't need to outlive the call.
+    */
+    class Batch_compiler
+    {
+    public:
+        /**
+         * @param thread_count The amount of worker threads. If zero, one thread per hardware thread is used.
+        */
+        explicit Batch_compiler(uint32_t thread_count = 0);
+
+        Batch_compiler(const Batch_compiler& other) = delete;
+        Batch_compiler& operator=(const Batch_compiler& other) = delete;
+
+        /**
+         * @brief Compiles the job on any worker thread.
+         * @details If the code could not compile, `std::future::get` throws a `Glsl_compiler_error`.
+        */
+        std::future<Compile_result> compile(Compile_job job);
+
+        /**
+         * @brief Compiles all jobs concurrently.
+         * @return One future per job, in the order of the jobs. Errors are reported per job,
+         * see the single job overload.
+        */
+        std::vector<std::future<Compile_result>> compile(std::span<const Compile_job> jobs);
+
+        uint32_t thread_count() const { return m_thread_pool.thread_count(); }
+
+    private:
+        /**
+         * @brief Holds a reference to the glslang process state for the lifetime of the workers.
+        */
+        struct Process_reference
+        {
+            Process_reference();
+            ~Process_reference();
+        };
+
+    private:
+        Process_reference m_process_reference;
+        thread::Thread_pool m_thread_pool;
+    };
+}
@@ -22,6 +22,17 @@ namespace ygg::vk::glsl_compiler
         glslang::FinalizeProcess();
     }
 
+    std::string compiler_version()
+    {
+        auto version = glslang::GetVersion();
+        std::string result = std::to_string(version.major) + "." + std::to_string(version.minor) + "." +
+            std::to_string(version.patch);
+        if (version.flavor != nullptr && version.flavor[0] != '\0') {
+            result += "-" + std::string(version.flavor);
+        }
+        return result;
+    }
+
     EShLanguage Shader_flags_to_lang(VkShaderStageFlags type)
     {
         switch (type)
@@ -194,14 +205,59 @@ namespace ygg::vk::glsl_compiler
 
     std::vector<uint32_t> compile_spirv_1_6(const std::string& code, VkShaderStageFlags shader_stage,
         const std::span<std::string>& include_dirs)
+    {
+        return compile_spirv_1_6(code, shader_stage, include_dirs, {}).spirv;
+    }
+
+    /**
+     * @brief Includer that records the path and content of every resolved include.
+    */
+    class Tracking_includer : public DirStackFileIncluder
+    {
+    public:
+        IncludeResult* includeSystem(const char* header_name, const char* includer_name,
+            size_t inclusion_depth) override
+        {
+            return track(DirStackFileIncluder::includeSystem(header_name, includer_name, inclusion_depth));
+        }
+
+        IncludeResult* includeLocal(const char* header_name, const char* includer_name,
+            size_t inclusion_depth) override
+        {
+            return track(DirStackFileIncluder::includeLocal(header_name, includer_name, inclusion_depth));
+        }
+
+        std::vector<Include_file> includes = {};
+
+    private:
+        IncludeResult* track(IncludeResult* result)
+        {
+            if (result != nullptr) {
+                includes.push_back({
+                    .path = result->headerName,
+                    .content = std::string(result->headerData, result->headerLength)
+                    });
+            }
+            return result;
+        }
+    };
+
+    Compile_result compile_spirv_1_6(const std::string& code, VkShaderStageFlags shader_stage,
+        std::span<const std::string> include_dirs, std::span<const Shader_define> defines)
     {
         auto type = Shader_flags_to_lang(shader_stage);
         auto shader = glslang::TShader(type);
         auto messages = EShMessages(EShMsgSpvRules | EShMsgVulkanRules);
-        auto includer = DirStackFileIncluder();
+        auto includer = Tracking_includer();
+
+        std::string preamble = {};
+        for (const auto& define : defines) {
+            preamble += "#define " + define.name + " " + define.value + "\n";
+        }
 
         const char* cstr_code = code.c_str();
         shader.setStrings(&cstr_code, 1);
+        shader.setPreamble(preamble.c_str());
         shader.setEnvInput(glslang::EShSourceGlsl, type, glslang::EShClientVulkan, CLIENT_INPUT_SEMANTICS_VERSION);
         shader.setEnvClient(glslang::EShClientVulkan, VULKAN_CLIENT_VERSION);
         shader.setEnvTarget(glslang::EShTargetSpv, TARGET_SPIRV_VERSION);
@@ -223,7 +279,10 @@ namespace ygg::vk::glsl_compiler
             throw Glsl_compiler_error(std::string("Shader link error.\n") + shader.getInfoLog());
         }
 
-        return compile_spirv_1_6(type, program);
+        return {
+            .spirv = compile_spirv_1_6(type, program),
+            .includes = std::move(includer.includes)
+        };
     }
 
     std::vector<uint32_t> compile_spirv_1_6_unchecked(const std::string& code, VkShaderStageFlags shader_stage)
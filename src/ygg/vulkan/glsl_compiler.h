@@ -31,6 +31,46 @@ namespace ygg::vk::glsl_compiler
         Glsl_compiler_error() = default;
     };
 
+    /**
+     * @brief Identifies the client and target environment all code is compiled for.
+     * @details Used to invalidate cached Spirv once the target changes.
+    */
+    constexpr const char* TARGET_ENVIRONMENT = "vulkan1.3-spirv1.6";
+
+    /**
+     * @brief Returns the version of the linked glslang, e.g. `11.12.0`.
+     * @details Used to invalidate cached Spirv once the compiler changes.
+    */
+    std::string compiler_version();
+
+    /**
+     * @brief A `#define name value` prepended to the compiled code.
+    */
+    struct Shader_define
+    {
+        std::string name;
+        std::string value;
+    };
+
+    /**
+     * @brief A file that was included while compiling.
+    */
+    struct Include_file
+    {
+        std::string path;
+        std::string content;
+    };
+
+    struct Compile_result
+    {
+        std::vector<uint32_t> spirv;
+
+        /**
+         * All files resolved by `#include` directives, in the order they were included.
+        */
+        std::vector<Include_file> includes;
+    };
+
     /**
      * @brief Compiles the provided code into Spirv 1.6.
      * @details This function may throw if the provided code could not compile.
@@ -44,6 +84,13 @@ namespace ygg::vk::glsl_compiler
     std::vector<uint32_t> compile_spirv_1_6(const std::string& code, VkShaderStageFlags shader_stage,
         const std::span<std::string>& include_dirs);
 
+    /**
+     * @brief Compiles the provided code into Spirv 1.6 and records all included files.
+     * @details This function may throw if the provided code could not compile.
+    */
+    Compile_result compile_spirv_1_6(const std::string& code, VkShaderStageFlags shader_stage,
+        std::span<const std::string> include_dirs, std::span<const Shader_define> defines);
+
     /**
      * @brief Compiles the provided code into Spirv 1.6.
      * @details This function may *crash* if the provided code could not compile.
@@ -139,7 +139,7 @@ namespace ygg::vk::img_utils
         case VK_FORMAT_R32G32B32A32_SINT:        return { VK_FORMAT_R32G32B32A32_SINT,        Int,           "R32G32B32A32_SINT",         true,  true,  true,  true,  false, false, true,  false, 16,  1 };
         case VK_FORMAT_R32G32B32A32_SFLOAT:      return { VK_FORMAT_R32G32B32A32_SFLOAT,      Float,         "R32G32B32A32_SFLOAT",       true,  true,  true,  true,  false, false, true,  false, 16,  1 };
         //                                                Format                              Type           Name                         red    green  blue   alpha  depth  stncl  signed srgb   size block
-        case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:   return { VK_FORMAT_E5B9G9R9_UFLOAT_PACK32,   Float,         "E5B9G9R9_UFLOAT_PACK32",    true,  true,  true,  false, false, false, false, false, 32,  1 };
+        case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:   return { VK_FORMAT_E5B9G9R9_UFLOAT_PACK32,   Float,         "E5B9G9R9_UFLOAT_PACK32",    true,  true,  true,  false, false, false, false, false, 4,   1 };
         //                                                Format                              Type           Name                         red    green  blue   alpha  depth  stncl  signed srgb   size block
         case VK_FORMAT_D16_UNORM:                return { VK_FORMAT_D16_UNORM,                Depth_stencil, "D16_UNORM",                 false, false, false, false, true,  false, false, false, 2,   1 };
         case VK_FORMAT_X8_D24_UNORM_PACK32:      return { VK_FORMAT_X8_D24_UNORM_PACK32,      Depth_stencil, "X8_D24_UNORM_PACK32",       false, false, false, false, true,  false, false, false, 4,   1 };
@@ -183,4 +183,42 @@ namespace ygg::vk::img_utils
         auto info = get_format_info(format);
         return info.texel_size;
     }
+
+    uint32_t format_block_extent(VkFormat format)
+    {
+        auto info = get_format_info(format);
+        return info.block_size > 0 ? info.block_size : 1;
+    }
+
+    VkDeviceSize get_region_size(VkFormat format, uint32_t width, uint32_t height, uint32_t depth)
+    {
+        VkDeviceSize block_extent = format_block_extent(format);
+        VkDeviceSize blocks_x = (VkDeviceSize(width) + block_extent - 1) / block_extent;
+        VkDeviceSize blocks_y = (VkDeviceSize(height) + block_extent - 1) / block_extent;
+        return blocks_x * blocks_y * depth * format_size(format);
+    }
+
+    uint32_t get_mip_extent(uint32_t extent, uint32_t mip_level)
+    {
+        uint32_t result = extent >> mip_level;
+        return result > 0 ? result : 1;
+    }
+
+    VkDeviceSize get_mip_level_size(const Image_info& img_info, uint32_t mip_level)
+    {
+        return get_region_size(img_info.format,
+            get_mip_extent(img_info.width, mip_level),
+            get_mip_extent(img_info.height, mip_level),
+            get_mip_extent(img_info.depth, mip_level));
+    }
+
+    VkDeviceSize get_mip_chain_size(const Image_info& img_info, uint32_t base_mip_level, uint32_t mip_levels,
+        uint32_t layers)
+    {
+        VkDeviceSize result = 0;
+        for (uint32_t mip = base_mip_level; mip < base_mip_level + mip_levels; mip++) {
+            result += get_mip_level_size(img_info, mip) * layers;
+        }
+        return result;
+    }
 }
@@ -93,5 +93,33 @@ namespace ygg::vk
          * @brief Returns the size for each texel in a given `VkFormat`.
         */
         uint32_t format_size(VkFormat format);
+
+        /**
+         * @brief Returns the width and height in texels of a single block in a given `VkFormat`.
+         * @details Returns `4` for BCn formats and `1` for all uncompressed formats.
+        */
+        uint32_t format_block_extent(VkFormat format);
+
+        /**
+         * @brief Returns the tightly packed size in bytes of a region with the given extent.
+         * @details The width and height are rounded up to whole blocks for block-compressed formats.
+        */
+        VkDeviceSize get_region_size(VkFormat format, uint32_t width, uint32_t height, uint32_t depth);
+
+        /**
+         * @brief Returns the extent of a single dimension at the given mip level, which is at least `1`.
+        */
+        uint32_t get_mip_extent(uint32_t extent, uint32_t mip_level);
+
+        /**
+         * @brief Returns the tightly packed size in bytes of a single array layer of the given mip level.
+        */
+        VkDeviceSize get_mip_level_size(const Image_info& img_info, uint32_t mip_level);
+
+        /**
+         * @brief Returns the tightly packed size in bytes of the given mip levels and array layers.
+        */
+        VkDeviceSize get_mip_chain_size(const Image_info& img_info, uint32_t base_mip_level, uint32_t mip_levels,
+            uint32_t layers);
     }
 }
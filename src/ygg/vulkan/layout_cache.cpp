@@ -0,0 +1,198 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/vulkan/layout_cache.h"
+
+#include "ygg/common/hash.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <volk.h>
+
+namespace ygg::vk
+{
+    uint64_t hash_descriptor_set_layout_info(const Descriptor_set_layout_info& info)
+    {
+        uint64_t result = hash::fnv_1a_64_value(info.flags);
+        result = hash::fnv_1a_64_value(info.bindings.size(), result);
+        for (const auto& binding : info.bindings) {
+            result = hash::fnv_1a_64_value(binding.binding, result);
+            result = hash::fnv_1a_64_value(binding.type, result);
+            result = hash::fnv_1a_64_value(binding.count, result);
+            result = hash::fnv_1a_64_value(binding.stages, result);
+            result = hash::fnv_1a_64_value(binding.flags, result);
+            result = hash::fnv_1a_64(binding.immutable_samplers.data(),
+                binding.immutable_samplers.size() * sizeof(VkSampler), result);
+        }
+        return result;
+    }
+
+    bool is_same_descriptor_set_layout_info(const Descriptor_set_layout_info& a, const Descriptor_set_layout_info& b)
+    {
+        return a.flags == b.flags && std::equal(a.bindings.begin(), a.bindings.end(),
+            b.bindings.begin(), b.bindings.end(), [](const auto& x, const auto& y) {
+                return x.binding == y.binding && x.type == y.type && x.count == y.count &&
+                    x.stages == y.stages && x.flags == y.flags && x.immutable_samplers == y.immutable_samplers;
+            });
+    }
+
+    bool is_same_push_constant_range(const Pipeline_layout_push_constant_range& a,
+        const Pipeline_layout_push_constant_range& b)
+    {
+        return a.size == b.size && a.offset == b.offset && a.stages == b.stages;
+    }
+
+    template<typename Handle>
+    void erase_lookup(std::unordered_multimap<uint64_t, Handle>& lookup, uint64_t key, Handle handle)
+    {
+        auto [first, last] = lookup.equal_range(key);
+        for (auto it = first; it != last; ++it) {
+            if (it->second == handle) {
+                lookup.erase(it);
+                return;
+            }
+        }
+    }
+
+    Layout_cache::Layout_cache(VkDevice device)
+        : m_device(device)
+    {}
+
+    Layout_cache::~Layout_cache()
+    {
+        for (auto& [layout, entry] : m_pipeline_layouts) {
+            vkDestroyPipelineLayout(m_device, layout, nullptr);
+        }
+        for (auto& [layout, entry] : m_set_layouts) {
+            vkDestroyDescriptorSetLayout(m_device, layout, nullptr);
+        }
+    }
+
+    VkDescriptorSetLayout Layout_cache::acquire_descriptor_set_layout(const Descriptor_set_layout_info& info)
+    {
+        uint64_t key = hash_descriptor_set_layout_info(info);
+        auto [first, last] = m_set_layout_lookup.equal_range(key);
+        for (auto it = first; it != last; ++it) {
+            auto& entry = m_set_layouts.at(it->second);
+            if (is_same_descriptor_set_layout_info(entry.info, info)) {
+                entry.references++;
+                return it->second;
+            }
+        }
+        auto layout = create_descriptor_set_layout(m_device, info);
+        m_set_layouts.emplace(layout, Set_layout_entry{ .key = key, .references = 1, .info = info });
+        m_set_layout_lookup.emplace(key, layout);
+        return layout;
+    }
+
+    VkPipelineLayout Layout_cache::acquire_pipeline_layout(std::span<const VkDescriptorSetLayout> set_layouts,
+        std::span<const Pipeline_layout_push_constant_range> push_constant_ranges)
+    {
+        uint64_t key = hash::fnv_1a_64_value(set_layouts.size());
+        key = hash::fnv_1a_64(set_layouts.data(), set_layouts.size_bytes(), key);
+        for (const auto& range : push_constant_ranges) {
+            key = hash::fnv_1a_64_value(range.size, key);
+            key = hash::fnv_1a_64_value(range.offset, key);
+            key = hash::fnv_1a_64_value(range.stages, key);
+        }
+
+        auto [first, last] = m_pipeline_layout_lookup.equal_range(key);
+        for (auto it = first; it != last; ++it) {
+            auto& entry = m_pipeline_layouts.at(it->second);
+            if (std::equal(entry.set_layouts.begin(), entry.set_layouts.end(), set_layouts.begin(), set_layouts.end()) &&
+                std::equal(entry.push_constant_ranges.begin(), entry.push_constant_ranges.end(),
+                    push_constant_ranges.begin(), push_constant_ranges.end(), is_same_push_constant_range)) {
+                entry.references++;
+                return it->second;
+            }
+        }
+
+        Pipeline_layout_entry entry = {
+            .key = key,
+            .references = 1,
+            .set_layouts = { set_layouts.begin(), set_layouts.end() },
+            .push_constant_ranges = { push_constant_ranges.begin(), push_constant_ranges.end() }
+        };
+        for (auto set_layout : entry.set_layouts) {
+            auto it = m_set_layouts.find(set_layout);
+            assert(it != m_set_layouts.end() && "Pipeline layouts can only use set layouts of the cache.");
+            it->second.references++;
+        }
+        Pipeline_layout_info info = {
+            .layouts = entry.set_layouts,
+            .push_constant_ranges = entry.push_constant_ranges
+        };
+        auto layout = create_pipeline_layout(m_device, info);
+        m_pipeline_layouts.emplace(layout, std::move(entry));
+        m_pipeline_layout_lookup.emplace(key, layout);
+        return layout;
+    }
+
+    Reflected_pipeline_layout Layout_cache::acquire_pipeline_layout(const Shader_reflection& reflection)
+    {
+        Reflected_pipeline_layout result = {
+            .set_layouts = {},
+            .layout = nullptr
+        };
+        result.set_layouts.reserve(reflection.sets.size());
+        for (std::size_t set = 0; set < reflection.sets.size(); set++) {
+            Descriptor_set_layout_info info = {
+                .flags = 0,
+                .bindings = reflection.sets[set]
+            };
+            for (const auto& binding : info.bindings) {
+                if (binding.count == 0) {
+                    printf("Runtime array at set %zu, binding %u requires an explicit descriptor count.\n",
+                        set, binding.binding); // TODO: logging?
+                    std::abort();
+                }
+            }
+            result.set_layouts.push_back(acquire_descriptor_set_layout(info));
+        }
+
+        std::vector<Pipeline_layout_push_constant_range> push_constant_ranges = {};
+        if (reflection.push_constant_range.has_value()) {
+            push_constant_ranges.push_back(reflection.push_constant_range.value());
+        }
+        result.layout = acquire_pipeline_layout(result.set_layouts, push_constant_ranges);
+        return result;
+    }
+
+    const Descriptor_set_layout_info& Layout_cache::descriptor_set_layout_info(VkDescriptorSetLayout layout) const
+    {
+        auto it = m_set_layouts.find(layout);
+        assert(it != m_set_layouts.end() && "Querying a set layout that is not owned by the cache.");
+        return it->second.info;
+    }
+
+    bool Layout_cache::release_descriptor_set_layout(VkDescriptorSetLayout layout)
+    {
+        auto it = m_set_layouts.find(layout);
+        assert(it != m_set_layouts.end() && "Releasing a set layout that is not owned by the cache.");
+        if (--it->second.references > 0) {
+            return false;
+        }
+        erase_lookup(m_set_layout_lookup, it->second.key, layout);
+        m_set_layouts.erase(it);
+        return true;
+    }
+
+    bool Layout_cache::release_pipeline_layout(VkPipelineLayout layout,
+        std::vector<VkDescriptorSetLayout>& released_set_layouts)
+    {
+        auto it = m_pipeline_layouts.find(layout);
+        assert(it != m_pipeline_layouts.end() && "Releasing a pipeline layout that is not owned by the cache.");
+        if (--it->second.references > 0) {
+            return false;
+        }
+        for (auto set_layout : it->second.set_layouts) {
+            if (release_descriptor_set_layout(set_layout)) {
+                released_set_layouts.push_back(set_layout);
+            }
+        }
+        erase_lookup(m_pipeline_layout_lookup, it->second.key, layout);
+        m_pipeline_layouts.erase(it);
+        return true;
+    }
+}
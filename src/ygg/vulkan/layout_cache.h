@@ -0,0 +1,111 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include "ygg/vulkan/descriptors.h"
+#include "ygg/vulkan/spirv_reflection.h"
+#include "ygg/vulkan/vk_forward_decl.h"
+
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace ygg::vk
+{
+    /**
+     * @brief Layouts of a pipeline created from a `Shader_reflection`.
+    */
+    struct Reflected_pipeline_layout
+    {
+        /**
+         * One layout per set, indexed by set number. Sets without bindings use an empty layout.
+        */
+        std::vector<VkDescriptorSetLayout> set_layouts;
+        VkPipelineLayout layout;
+    };
+
+    /**
+     * @brief Hash-consing cache for descriptor set and pipeline layouts.
+     * @details Layouts are keyed on their full contents, including flags, immutable samplers and push constant
+     * ranges. Requesting a layout equal to an existing one returns the existing handle, so equal layouts are
+     * pointer-equal and pipelines using them stay descriptor set compatible.
+     * Every request adds a reference that must be released again. A pipeline layout holds a reference to each
+     * of its set layouts, so a handle is never reused for a different layout while a pipeline layout
+     * referencing it is cached. Released layouts are removed from the cache and returned to the caller
+     * for destruction, so the caller decides whether to destroy them immediately or deferred.
+     * Layouts still referenced on destruction of the cache are destroyed with it.
+     * All functions must be externally synchronized.
+    */
+    class Layout_cache
+    {
+    public:
+        explicit Layout_cache(VkDevice device);
+        ~Layout_cache();
+
+        Layout_cache(const Layout_cache& other) = delete;
+        Layout_cache& operator=(const Layout_cache& other) = delete;
+
+        /**
+         * @brief Returns a layout matching the info and adds a reference to it.
+        */
+        VkDescriptorSetLayout acquire_descriptor_set_layout(const Descriptor_set_layout_info& info);
+
+        /**
+         * @brief Returns a layout matching the set layouts and push constant ranges and adds a reference to it.
+        */
+        VkPipelineLayout acquire_pipeline_layout(std::span<const VkDescriptorSetLayout> set_layouts,
+            std::span<const Pipeline_layout_push_constant_range> push_constant_ranges);
+
+        /**
+         * @brief Returns the layouts matching the merged reflection of all stages of a pipeline.
+         * @details Adds a reference to every returned set layout and the pipeline layout.
+         * Runtime arrays must be given a count before, see `Shader_reflection::sets`.
+        */
+        Reflected_pipeline_layout acquire_pipeline_layout(const Shader_reflection& reflection);
+
+        /**
+         * @brief Releases a reference to the layout.
+         * @return Whether or not the last reference was released. The layout is then removed from the cache
+         * and must be destroyed by the caller.
+        */
+        bool release_descriptor_set_layout(VkDescriptorSetLayout layout);
+
+        /**
+         * @brief Releases a reference to the layout, see `release_descriptor_set_layout`.
+         * @param released_set_layouts Receives the set layouts whose last reference was held by the
+         * released pipeline layout. They must be destroyed by the caller as well.
+        */
+        bool release_pipeline_layout(VkPipelineLayout layout, std::vector<VkDescriptorSetLayout>& released_set_layouts);
+
+        /**
+         * @brief Returns the info the layout was created with. The layout must be owned by the cache.
+        */
+        const Descriptor_set_layout_info& descriptor_set_layout_info(VkDescriptorSetLayout layout) const;
+
+        std::size_t descriptor_set_layout_count() const { return m_set_layouts.size(); }
+        std::size_t pipeline_layout_count() const { return m_pipeline_layouts.size(); }
+
+    private:
+        struct Set_layout_entry
+        {
+            uint64_t key;
+            uint32_t references;
+            Descriptor_set_layout_info info;
+        };
+
+        struct Pipeline_layout_entry
+        {
+            uint64_t key;
+            uint32_t references;
+            std::vector<VkDescriptorSetLayout> set_layouts;
+            std::vector<Pipeline_layout_push_constant_range> push_constant_ranges;
+        };
+
+    private:
+        VkDevice m_device;
+        std::unordered_map<VkDescriptorSetLayout, Set_layout_entry> m_set_layouts = {};
+        std::unordered_map<VkPipelineLayout, Pipeline_layout_entry> m_pipeline_layouts = {};
+        std::unordered_multimap<uint64_t, VkDescriptorSetLayout> m_set_layout_lookup = {};
+        std::unordered_multimap<uint64_t, VkPipelineLayout> m_pipeline_layout_lookup = {};
+    };
+}
@@ -2,38 +2,116 @@
 
 #include "ygg/vulkan/linear_host_resource_allocator.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
 #include <volk.h>
 #include <vk_mem_alloc.h>
 
 namespace ygg::vk
 {
-    Linear_host_resource_allocator::Linear_host_resource_allocator(VmaAllocator allocator)
-        : m_allocator(allocator), m_pool(VK_NULL_HANDLE), m_allocated_buffers()
+    VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment)
     {
-        uint32_t memory_type_index;
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    VmaPool create_linear_host_resource_pool(VmaAllocator allocator)
+    {
+        uint32_t memory_type_index = 0;
         VmaAllocationCreateInfo allocation_create_info = {
-            .usage = VMA_MEMORY_USAGE_CPU_ONLY
+            .usage = VMA_MEMORY_USAGE_CPU_ONLY,
+            .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
         };
-        vmaFindMemoryTypeIndex(m_allocator, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            &allocation_create_info, &memory_type_index);
+        // Any memory type is acceptable as long as it has the required properties.
+        if (vmaFindMemoryTypeIndex(allocator, UINT32_MAX, &allocation_create_info, &memory_type_index) != VK_SUCCESS) {
+            printf("There is no host visible and coherent memory type for staging buffers."); // TODO: logging?
+            std::abort();
+        }
         VmaPoolCreateInfo pool_info = {
             .memoryTypeIndex = memory_type_index,
-            .flags = VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT |
-                VMA_POOL_CREATE_IGNORE_BUFFER_IMAGE_GRANULARITY_BIT
+            .flags = VMA_POOL_CREATE_IGNORE_BUFFER_IMAGE_GRANULARITY_BIT
         };
-        vmaCreatePool(m_allocator, &pool_info, &m_pool);
+        VmaPool result = VK_NULL_HANDLE;
+        if (vmaCreatePool(allocator, &pool_info, &result) != VK_SUCCESS) {
+            printf("The staging buffer pool could not be created."); // TODO: logging?
+            std::abort();
+        }
+        return result;
     }
 
+    Linear_host_resource_allocator::Linear_host_resource_allocator(VmaAllocator allocator, VmaPool pool,
+        uint32_t queue_family_index, VkDeviceSize block_size)
+        : m_allocator(allocator), m_pool(pool), m_queue_family_index(queue_family_index),
+        m_block_size(block_size), m_blocks()
+    {}
+
     Linear_host_resource_allocator::~Linear_host_resource_allocator()
     {
-        reset();
-        vmaDestroyPool(m_allocator, m_pool);
+        destroy_blocks();
+    }
+
+    Linear_host_resource_allocator::Mapped_host_buffer Linear_host_resource_allocator::allocate_buffer(VkDeviceSize size,
+        VkDeviceSize alignment)
+    {
+        assert(alignment > 0);
+        while (m_current_block < m_blocks.size()) {
+            auto& block = m_blocks[m_current_block];
+            VkDeviceSize offset = align_up(m_current_offset, alignment);
+            if (offset + size <= block.size) {
+                m_current_offset = offset + size;
+                return { block.buf, offset, block.mapped_data + offset };
+            }
+            // The rest of the block is skipped and must not count towards the high-water mark.
+            block.used_size = m_current_offset;
+            m_current_block += 1;
+            m_current_offset = 0;
+        }
+
+        allocate_block(std::max(m_block_size, size));
+        m_current_block = m_blocks.size() - 1;
+        m_current_offset = size;
+        auto& block = m_blocks.back();
+        return { block.buf, 0, block.mapped_data };
+    }
+
+    void Linear_host_resource_allocator::reset()
+    {
+        m_high_water_mark = std::max(m_high_water_mark, bytes_used());
+        if (m_blocks.size() > 1) {
+            destroy_blocks();
+            allocate_block(align_up(m_high_water_mark, m_block_size));
+        }
+        m_block_allocation_count = 0;
+        m_current_block = 0;
+        m_current_offset = 0;
     }
 
-    Linear_host_resource_allocator::Mapped_host_buffer& Linear_host_resource_allocator::allocate_buffer(VkDeviceSize size,
-        uint32_t queue_family_index)
+    VkDeviceSize Linear_host_resource_allocator::bytes_used() const
     {
-        auto& result = m_allocated_buffers.emplace_back();
+        VkDeviceSize result = 0;
+        for (std::size_t i = 0; i < m_current_block && i < m_blocks.size(); i++) {
+            result += m_blocks[i].used_size;
+        }
+        if (m_current_block < m_blocks.size()) {
+            result += m_current_offset;
+        }
+        return result;
+    }
+
+    VkDeviceSize Linear_host_resource_allocator::bytes_reserved() const
+    {
+        VkDeviceSize result = 0;
+        for (const auto& block : m_blocks) {
+            result += block.size;
+        }
+        return result;
+    }
+
+    void Linear_host_resource_allocator::allocate_block(VkDeviceSize size)
+    {
+        auto& block = m_blocks.emplace_back();
         VkBufferCreateInfo buffer_info = {
             .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
             .pNext = nullptr,
@@ -41,42 +119,67 @@ namespace ygg::vk
             .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
             .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
             .queueFamilyIndexCount = 1,
-            .pQueueFamilyIndices = &queue_family_index
+            .pQueueFamilyIndices = &m_queue_family_index
         };
         VmaAllocationCreateInfo allocation_create_info = {
             .flags = VMA_ALLOCATION_CREATE_MAPPED_BIT,
             .pool = m_pool
         };
         VmaAllocationInfo allocation_info = {};
-        vmaCreateBuffer(m_allocator, &buffer_info, &allocation_create_info, &result.buf,
-            &result.allocation, &allocation_info);
-        result.mapped_data = allocation_info.pMappedData;
-        return result;
+        vmaCreateBuffer(m_allocator, &buffer_info, &allocation_create_info, &block.buf,
+            &block.allocation, &allocation_info);
+        block.mapped_data = static_cast<uint8_t*>(allocation_info.pMappedData);
+        block.size = size;
+        m_block_allocation_count += 1;
     }
 
-    void Linear_host_resource_allocator::reset()
+    void Linear_host_resource_allocator::destroy_blocks()
     {
-        for (auto& buf : m_allocated_buffers)
-            vmaDestroyBuffer(m_allocator, buf.buf, buf.allocation);
-        m_allocated_buffers.clear();
+        for (auto& block : m_blocks) {
+            vmaDestroyBuffer(m_allocator, block.buf, block.allocation);
+        }
+        m_blocks.clear();
     }
 
     Linear_host_resource_allocator_provider::Linear_host_resource_allocator_provider(VmaAllocator allocator)
-        : m_allocator(allocator), m_allocators()
+        : m_allocator(allocator), m_pool(create_linear_host_resource_pool(allocator)), m_allocators()
     {}
 
     Linear_host_resource_allocator_provider::~Linear_host_resource_allocator_provider()
     {
-        reset();
+        m_allocators.clear();
+        vmaDestroyPool(m_allocator, m_pool);
     }
 
-    Linear_host_resource_allocator& Linear_host_resource_allocator_provider::create_allocator()
+    Linear_host_resource_allocator& Linear_host_resource_allocator_provider::create_allocator(uint32_t queue_family_index)
     {
-        return *m_allocators.emplace_back(std::make_unique<Linear_host_resource_allocator>(m_allocator)).get();
+        for (std::size_t i = m_used_allocator_count; i < m_allocators.size(); i++) {
+            if (m_allocators[i]->queue_family_index() == queue_family_index) {
+                std::swap(m_allocators[i], m_allocators[m_used_allocator_count]);
+                return *m_allocators[m_used_allocator_count++].get();
+            }
+        }
+        m_allocators.emplace_back(std::make_unique<Linear_host_resource_allocator>(m_allocator, m_pool, queue_family_index));
+        std::swap(m_allocators.back(), m_allocators[m_used_allocator_count]);
+        return *m_allocators[m_used_allocator_count++].get();
     }
 
     void Linear_host_resource_allocator_provider::reset()
     {
-        m_allocators.clear();
+        m_statistics = {
+            .allocator_count = uint32_t(m_used_allocator_count),
+            .block_allocation_count = 0,
+            .bytes_used = 0,
+            .bytes_reserved = 0
+        };
+        for (std::size_t i = 0; i < m_used_allocator_count; i++) {
+            m_statistics.block_allocation_count += m_allocators[i]->block_allocation_count();
+            m_statistics.bytes_used += m_allocators[i]->bytes_used();
+            m_allocators[i]->reset();
+        }
+        for (const auto& allocator : m_allocators) {
+            m_statistics.bytes_reserved += allocator->bytes_reserved();
+        }
+        m_used_allocator_count = 0;
     }
 }
@@ -9,54 +9,129 @@
 
 namespace ygg::vk
 {
+    /**
+     * @brief Staging usage of a Linear_host_resource_allocator_provider for a single frame.
+    */
+    struct Linear_host_resource_allocator_statistics
+    {
+        uint32_t allocator_count;
+        uint32_t block_allocation_count;
+        VkDeviceSize bytes_used;
+        VkDeviceSize bytes_reserved;
+    };
+
+    /**
+     * @brief Creates the host visible and coherent `VmaPool` that `Linear_host_resource_allocator` blocks are allocated from.
+     * @details The caller owns the pool and must destroy it after all allocators using it.
+    */
+    VmaPool create_linear_host_resource_pool(VmaAllocator allocator);
+
     /**
      * @brief Fast Buffer-allocator for transient resource uploads.
+     * @details Sub-allocates from large persistently mapped blocks by bumping an offset.
+     * If the current block is exhausted, another block is chained. `reset()` rewinds to
+     * the first block without freeing any memory, so the blocks act as a ring that is
+     * reused every time the owning frame in flight comes around.
     */
     class Linear_host_resource_allocator
     {
     public:
         /**
-         * @brief Single-time allocated buffer residing in write-combined host memory.
+         * @brief Sub-range of a block residing in write-combined host memory.
         */
         struct Mapped_host_buffer
         {
             VkBuffer buf;
-            VmaAllocation allocation;
+            VkDeviceSize offset;
             void* mapped_data;
         };
 
+        constexpr static VkDeviceSize DEFAULT_BLOCK_SIZE = 8ull * 1024ull * 1024ull;
+        constexpr static VkDeviceSize DEFAULT_ALIGNMENT = 16ull;
+
     public:
         /**
          * @brief Creates a `Linear_host_resource_allocator` instance using the given `VmaAllocator`.
          * @param allocator The `VmaAllocator` to use.
+         * @param pool The host visible `VmaPool` to allocate blocks from.
+         * @param queue_family_index The queue family index to which all allocated blocks belong to.
+         * @param block_size The minimum size of every block allocated by this instance.
         */
-        explicit Linear_host_resource_allocator(VmaAllocator allocator);
+        Linear_host_resource_allocator(VmaAllocator allocator, VmaPool pool, uint32_t queue_family_index,
+            VkDeviceSize block_size = DEFAULT_BLOCK_SIZE);
         ~Linear_host_resource_allocator();
 
+        Linear_host_resource_allocator(const Linear_host_resource_allocator& other) = delete;
+        Linear_host_resource_allocator& operator=(const Linear_host_resource_allocator& other) = delete;
+
         /**
-         * @brief Allocates a buffer which is write-combined and mapped.
-         * @details The returned buffer should not be read from. Any read from this buffer may be
+         * @brief Allocates a sub-range of a block which is write-combined and mapped.
+         * @details The returned range should not be read from. Any read from this range may be
          * extremely slow and cause heavy performance penalties. This also goes for indirect reads
          * such as using `+=` or similar on the elements inside.
          * @param size The size of the allocation.
-         * @param queue_family_index The queue family index to which this allocated buffer belongs to.
-         * @return Transient mapped allocation, to be freed on `reset()`.
+         * @param alignment The alignment of the returned offset. Does not need to be a power of two.
+         * @return Transient mapped range, valid until `reset()`. `mapped_data` already points to `offset`.
         */
-        Mapped_host_buffer& allocate_buffer(VkDeviceSize size, uint32_t queue_family_index);
+        Mapped_host_buffer allocate_buffer(VkDeviceSize size, VkDeviceSize alignment = DEFAULT_ALIGNMENT);
 
         /**
-         * @brief Frees all buffers allocated from this instance.
+         * @brief Rewinds this instance to the first block. Previously allocated ranges must not be in use anymore.
+         * @details If more than one block was required since the last reset, all blocks are replaced
+         * with a single block sized after the high-water mark, so following uses fit into it.
         */
         void reset();
 
+        /**
+         * @brief Returns the queue family index all blocks of this instance belong to.
+        */
+        uint32_t queue_family_index() const { return m_queue_family_index; }
+
+        /**
+         * @brief Returns the amount of bytes consumed since the last reset, including alignment padding.
+        */
+        VkDeviceSize bytes_used() const;
+
+        /**
+         * @brief Returns the size of all blocks owned by this instance.
+        */
+        VkDeviceSize bytes_reserved() const;
+
+        /**
+         * @brief Returns the amount of blocks allocated since the last reset.
+        */
+        uint32_t block_allocation_count() const { return m_block_allocation_count; }
+
+    private:
+        struct Block
+        {
+            VkBuffer buf;
+            VmaAllocation allocation;
+            uint8_t* mapped_data;
+            VkDeviceSize size;
+            VkDeviceSize used_size; // The offset at which the block was left, valid for blocks before the current one.
+        };
+
+        void allocate_block(VkDeviceSize size);
+        void destroy_blocks();
+
     private:
         VmaAllocator m_allocator;
         VmaPool m_pool;
-        std::vector<Mapped_host_buffer> m_allocated_buffers;
+        uint32_t m_queue_family_index;
+        VkDeviceSize m_block_size;
+        VkDeviceSize m_high_water_mark = 0;
+        uint32_t m_block_allocation_count = 0;
+        std::vector<Block> m_blocks;
+        std::size_t m_current_block = 0;
+        VkDeviceSize m_current_offset = 0;
     };
 
     /**
-     * @brief Factory to instantiate and manage 'Linear_host_resource_allocator' instances.
+     * @brief Factory to instantiate and recycle 'Linear_host_resource_allocator' instances.
+     * @details All allocators share a single `VmaPool` that lives as long as the provider.
+     * Allocators are never destroyed on `reset()` but handed out again, so steady-state frames
+     * do not create any pools, blocks or device memory.
     */
     class Linear_host_resource_allocator_provider
     {
@@ -69,19 +144,34 @@ namespace ygg::vk
         explicit Linear_host_resource_allocator_provider(VmaAllocator allocator);
         ~Linear_host_resource_allocator_provider();
 
+        Linear_host_resource_allocator_provider(const Linear_host_resource_allocator_provider& other) = delete;
+        Linear_host_resource_allocator_provider& operator=(const Linear_host_resource_allocator_provider& other) = delete;
+
         /**
-         * @brief Creates a `Linear_host_resource_allocator` instance with the `VmaAllocator` of this instance.
-         * @return The non-owned `Linear_host_resource_allocator` instance.
+         * @brief Returns a recycled `Linear_host_resource_allocator` instance or creates a new one
+         * if none with the given queue family index is available.
+         * @param queue_family_index The queue family index the allocator's blocks belong to.
+         * @return The non-owned `Linear_host_resource_allocator` instance, valid until `reset()`.
         */
-        Linear_host_resource_allocator& create_allocator();
+        Linear_host_resource_allocator& create_allocator(uint32_t queue_family_index);
 
         /**
-         * @brief Resets this provider, destroying all provided `Linear_host_resource_allocator` instances
-         * created from this instance.
+         * @brief Resets this provider, rewinding and recycling all `Linear_host_resource_allocator`
+         * instances created from this instance.
+         * @details The staging usage since the last reset is recorded and returned by `statistics()`.
         */
         void reset();
+
+        /**
+         * @brief Returns the staging usage between the last two calls to `reset()`.
+        */
+        const Linear_host_resource_allocator_statistics& statistics() const { return m_statistics; }
+
     private:
         VmaAllocator m_allocator;
+        VmaPool m_pool;
         std::vector<std::unique_ptr<Linear_host_resource_allocator>> m_allocators;
+        std::size_t m_used_allocator_count = 0;
+        Linear_host_resource_allocator_statistics m_statistics = {};
     };
 }
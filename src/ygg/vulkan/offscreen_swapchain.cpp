@@ -0,0 +1,70 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/vulkan/offscreen_swapchain.h"
+
+#include "ygg/vulkan/context.h"
+#include "ygg/vulkan/window_system_integration.h"
+
+#include <volk.h>
+
+namespace ygg::vk
+{
+    Offscreen_swapchain::Offscreen_swapchain(const Context& context, const Window_system_integration& wsi)
+        : m_context(context), m_wsi(wsi)
+    {
+        recreate();
+    }
+
+    Offscreen_swapchain::~Offscreen_swapchain()
+    {
+        cleanup();
+    }
+
+    void Offscreen_swapchain::acquire()
+    {
+        if (m_wsi.get_width() != m_width || m_wsi.get_height() != m_height) {
+            m_context.device_wait_idle();
+            recreate();
+        }
+        m_acquired_idx = m_context.current_frame_in_flight();
+    }
+
+    void Offscreen_swapchain::recreate()
+    {
+        cleanup();
+        m_width = m_wsi.get_width();
+        m_height = m_wsi.get_height();
+        if (m_width == 0 || m_height == 0) {
+            return;
+        }
+
+        Image_info info = {
+            .width = m_width,
+            .height = m_height,
+            .depth = 1,
+            .mip_levels = 1,
+            .array_layers = 1,
+            .format = VK_FORMAT_B8G8R8A8_SRGB,
+            .usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+            .type = VK_IMAGE_TYPE_2D
+        };
+        m_images.reserve(m_context.max_frames_in_flight());
+        for (uint32_t i = 0; i < m_context.max_frames_in_flight(); i++) {
+            m_images.emplace_back(m_context.create_image(info, m_context.graphics_queue().queue_family_index));
+        }
+    }
+
+    Image Offscreen_swapchain::image() const
+    {
+        return m_images[m_acquired_idx];
+    }
+
+    void Offscreen_swapchain::cleanup()
+    {
+        for (auto& image : m_images) {
+            m_context.destroy_image(image);
+        }
+        m_images.clear();
+        m_acquired_idx = ~0u;
+    }
+}
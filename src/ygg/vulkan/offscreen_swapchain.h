@@ -0,0 +1,60 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include "ygg/vulkan/resource.h"
+#include "ygg/vulkan/vk_forward_decl.h"
+
+#include <vector>
+
+namespace ygg::vk
+{
+    class Context;
+    class Window_system_integration;
+
+    /**
+     * @brief Stand-in for the Swapchain when running without a surface.
+     * @details Owns one offscreen Image per frame in flight, sized after the WSI.
+     * Acquiring and presenting do not involve any semaphores, the images are plain
+     * device local Images that can be blitted to and read back from.
+    */
+    class Offscreen_swapchain
+    {
+    public:
+        /**
+         * @brief Constructs an Offscreen_swapchain instance which binds to the given Context and WSI.
+        */
+        explicit Offscreen_swapchain(const Context& context, const Window_system_integration& wsi);
+        ~Offscreen_swapchain();
+
+        /**
+         * @brief Selects the image for the current frame in flight.
+         * @details If the WSI reports a different size than the current images have, this will
+         * cause a flush and recreate all images.
+        */
+        void acquire();
+
+        /**
+         * @brief Recreates all offscreen images.
+         * @details This should only be used when the images are not in use by any command buffer.
+        */
+        void recreate();
+
+        /**
+         * @brief Returns the currently acquired offscreen image.
+         * @details This should only be called after an Image has been acquired.
+        */
+        Image image() const;
+
+    private:
+        void cleanup();
+
+    private:
+        const Context& m_context;
+        const Window_system_integration& m_wsi;
+        uint32_t m_acquired_idx = ~0u;
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        std::vector<Image> m_images = {};
+    };
+}
@@ -49,10 +49,12 @@ namespace ygg::vk
             VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, buffer, offset, size);
     }
 
-    Pipeline_barrier_builder& Pipeline_barrier_builder::push_buffer_qfot_import_memory_barrier(VkBuffer buffer,
-        VkDeviceSize offset,VkDeviceSize size)
+    Pipeline_barrier_builder& Pipeline_barrier_builder::push_buffer_qfot_import_memory_barrier(
+        uint32_t src_queue_family_index, uint32_t dst_queue_family_index, VkBuffer buffer,
+        VkDeviceSize offset, VkDeviceSize size, VkPipelineStageFlags2 dst_stage_mask, VkAccessFlags2 dst_access_mask)
     {
-        return push_buffer_memory_barrier(0, 0, 0, 0, buffer, offset, size);
+        return push_buffer_memory_barrier(0, 0, dst_stage_mask, dst_access_mask, src_queue_family_index,
+            dst_queue_family_index, buffer, offset, size);
     }
 
     Pipeline_barrier_builder& Pipeline_barrier_builder::push_image_memory_barrier(VkPipelineStageFlags2 src_stage_mask,
@@ -76,10 +78,11 @@ namespace ygg::vk
 
     Pipeline_barrier_builder& Pipeline_barrier_builder::push_image_qfot_import_memory_barrier(VkImageLayout old_layout,
         VkImageLayout new_layout, uint32_t src_queue_family_index, uint32_t dst_queue_family_index,
-        VkImage image, const VkImageSubresourceRange& subresource_range)
+        VkImage image, const VkImageSubresourceRange& subresource_range,
+        VkPipelineStageFlags2 dst_stage_mask, VkAccessFlags2 dst_access_mask)
     {
-        return push_image_memory_barrier(0, 0, 0, 0, old_layout, new_layout, src_queue_family_index,
-            dst_queue_family_index, image, subresource_range);
+        return push_image_memory_barrier(0, 0, dst_stage_mask, dst_access_mask, old_layout, new_layout,
+            src_queue_family_index, dst_queue_family_index, image, subresource_range);
     }
 
     void Pipeline_barrier_builder::flush(VkDependencyFlags dependency_flags)
@@ -44,13 +44,16 @@ namespace ygg::vk
 
         /**
          * @brief Stores a buffer memory barrier specifying a queue ownership transfer, to be executed on `flush()`.
-         * @details QFOT works by pushing an image barrier from the src queue family specifying the dst queue family,
+         * @details QFOT works by pushing a buffer barrier from the src queue family specifying the dst queue family,
          * submitting the barriers and on the importing target specifying this barrier. The size and offset in both
          * barriers *must* match. Waiting on pipeline stage flags or access flags is not required as that should be
-         * done with the semaphore specifying the dependency between both submits.
+         * done with the semaphore specifying the dependency between both submits. The following commands can be
+         * ordered after the acquire operation using `dst_stage_mask` and `dst_access_mask`.
          * @return This instance.
         */
-        Pipeline_barrier_builder& push_buffer_qfot_import_memory_barrier(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size);
+        Pipeline_barrier_builder& push_buffer_qfot_import_memory_barrier(uint32_t src_queue_family_index,
+            uint32_t dst_queue_family_index, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size,
+            VkPipelineStageFlags2 dst_stage_mask = 0, VkAccessFlags2 dst_access_mask = 0);
 
         /**
          * @brief Stores a image memory barrier, to be executed on `flush()`.
@@ -74,12 +77,14 @@ namespace ygg::vk
          * @details QFOT works by pushing an image barrier from the src queue family specifying the dst queue family,
          * submitting the barriers and on the importing target specifying this barrier. The layouts used in both barriers
          * *must* match. Waiting on pipeline stage flags or access flags is not required as that should be done with the
-         * semaphore specifying the dependency between both submits.
+         * semaphore specifying the dependency between both submits. If the layouts differ, the following commands have
+         * to be ordered after the layout transition using `dst_stage_mask` and `dst_access_mask`.
          * @return This instance.
         */
         Pipeline_barrier_builder& push_image_qfot_import_memory_barrier(VkImageLayout old_layout, VkImageLayout new_layout,
             uint32_t src_queue_family_index, uint32_t dst_queue_family_index,
-            VkImage image, const VkImageSubresourceRange& subresource_range);
+            VkImage image, const VkImageSubresourceRange& subresource_range,
+            VkPipelineStageFlags2 dst_stage_mask = 0, VkAccessFlags2 dst_access_mask = 0);
 
         /**
          * @brief Flushes the barriers to be executed by the given command buffer.
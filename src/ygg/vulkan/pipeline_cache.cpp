@@ -0,0 +1,84 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/vulkan/pipeline_cache.h"
+
+#include "ygg/common/file_util.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <volk.h>
+
+namespace ygg::vk
+{
+    bool is_pipeline_cache_compatible(const std::vector<uint8_t>& data, VkPhysicalDevice physical_device)
+    {
+        VkPipelineCacheHeaderVersionOne header = {};
+        if (data.size() < sizeof(header)) {
+            return false;
+        }
+        memcpy(&header, data.data(), sizeof(header));
+        VkPhysicalDeviceProperties properties = {};
+        vkGetPhysicalDeviceProperties(physical_device, &properties);
+        return header.headerSize >= sizeof(header) &&
+            header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+            header.vendorID == properties.vendorID &&
+            header.deviceID == properties.deviceID &&
+            memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
+    Pipeline_cache::Pipeline_cache(VkDevice device, VkPhysicalDevice physical_device, const std::string& path)
+        : m_device(device), m_path(path)
+    {
+        std::vector<uint8_t> initial_data = {};
+        if (!m_path.empty()) {
+            try {
+                initial_data = file_util::file_to_bytes(m_path);
+            }
+            catch (const file_util::IO_error&) {
+                initial_data.clear();
+            }
+            // Data of another device or driver version would be ignored by the driver at best.
+            if (!initial_data.empty() && !is_pipeline_cache_compatible(initial_data, physical_device)) {
+                printf("Discarding incompatible pipeline cache '%s'.\n", m_path.c_str()); // TODO: logging?
+                initial_data.clear();
+            }
+        }
+        m_loaded = !initial_data.empty();
+
+        VkPipelineCacheCreateInfo info = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .initialDataSize = initial_data.size(),
+            .pInitialData = initial_data.data()
+        };
+        // TODO: add VK_CHECK
+        vkCreatePipelineCache(m_device, &info, nullptr, &m_cache);
+    }
+
+    Pipeline_cache::~Pipeline_cache()
+    {
+        vkDestroyPipelineCache(m_device, m_cache, nullptr);
+    }
+
+    bool Pipeline_cache::save() const
+    {
+        if (m_path.empty()) {
+            return false;
+        }
+        std::size_t size = 0;
+        vkGetPipelineCacheData(m_device, m_cache, &size, nullptr);
+        std::vector<uint8_t> data(size);
+        vkGetPipelineCacheData(m_device, m_cache, &size, data.data());
+        data.resize(size);
+        try {
+            file_util::bytes_to_file_atomic(m_path, data);
+        }
+        catch (const file_util::IO_error& error) {
+            printf("Failed to save pipeline cache: %s\n", error.what()); // TODO: logging?
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,50 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include "ygg/vulkan/vk_forward_decl.h"
+
+#include <string>
+
+namespace ygg::vk
+{
+    /**
+     * @brief Owns a `VkPipelineCache` that persists across application launches.
+     * @details On creation the cache is loaded from disk if the file exists and its header matches the
+     * vendor, device and pipeline cache UUID of the physical device. Otherwise an empty cache is created.
+     * Saving replaces the file atomically, so an interrupted save never leaves a corrupted cache behind.
+    */
+    class Pipeline_cache
+    {
+    public:
+        /**
+         * @brief Creates the cache, loading its initial data from the given path.
+         * @param path The file to load from and save to. If empty, the cache is not persisted.
+        */
+        Pipeline_cache(VkDevice device, VkPhysicalDevice physical_device, const std::string& path);
+        ~Pipeline_cache();
+
+        Pipeline_cache(const Pipeline_cache& other) = delete;
+        Pipeline_cache& operator=(const Pipeline_cache& other) = delete;
+
+        /**
+         * @brief Writes the current contents of the cache to disk.
+         * @details Failing to write the cache is not fatal and only reported.
+         * @return Whether or not the cache was written.
+        */
+        bool save() const;
+
+        /**
+         * @brief Returns whether or not the initial data was loaded from disk.
+        */
+        bool was_loaded() const { return m_loaded; }
+
+        VkPipelineCache handle() const { return m_cache; }
+
+    private:
+        VkDevice m_device;
+        VkPipelineCache m_cache = nullptr;
+        std::string m_path;
+        bool m_loaded = false;
+    };
+}
@@ -0,0 +1,53 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/vulkan/pipeline_compiler.h"
+
+#include <chrono>
+#include <volk.h>
+
+namespace ygg::vk
+{
+    Async_pipeline::Async_pipeline(std::shared_future<Pipeline> future)
+        : m_future(std::move(future))
+    {}
+
+    Async_pipeline Async_pipeline::from_pipeline(const Pipeline& pipeline)
+    {
+        std::promise<Pipeline> promise = {};
+        promise.set_value(pipeline);
+        return Async_pipeline(promise.get_future().share());
+    }
+
+    bool Async_pipeline::is_ready() const
+    {
+        return m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    Pipeline_compiler::Pipeline_compiler(VkDevice device, VkPipelineCache pipeline_cache,
+        Pipeline_library_cache* library_cache, uint32_t thread_count)
+        : m_device(device), m_pipeline_cache(pipeline_cache), m_library_cache(library_cache),
+        m_thread_pool(thread_count)
+    {}
+
+    Async_pipeline Pipeline_compiler::compile_graphics_pipeline(Graphics_pipeline_info info)
+    {
+        return Async_pipeline(m_thread_pool.submit([this, info = std::move(info)]() {
+            return Pipeline{
+                .handle = (m_library_cache != nullptr)
+                    ? m_library_cache->create_graphics_pipeline(info)
+                    : create_graphics_pipeline(m_device, info, m_pipeline_cache),
+                .bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS
+            };
+        }).share());
+    }
+
+    Async_pipeline Pipeline_compiler::compile_compute_pipeline(Compute_pipeline_info info)
+    {
+        return Async_pipeline(m_thread_pool.submit([this, info = std::move(info)]() {
+            return Pipeline{
+                .handle = create_compute_pipeline(m_device, info, m_pipeline_cache),
+                .bind_point = VK_PIPELINE_BIND_POINT_COMPUTE
+            };
+        }).share());
+    }
+}
@@ -0,0 +1,77 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include "ygg/thread/thread_pool.h"
+#include "ygg/vulkan/pipeline_library_cache.h"
+#include "ygg/vulkan/resource.h"
+#include "ygg/vulkan/vk_forward_decl.h"
+
+#include <future>
+
+namespace ygg::vk
+{
+    /**
+     * @brief Handle to a pipeline that may still be compiling.
+     * @details Copies share the same pipeline. A default constructed handle is invalid and must not be polled.
+    */
+    class Async_pipeline
+    {
+    public:
+        Async_pipeline() = default;
+        explicit Async_pipeline(std::shared_future<Pipeline> future);
+
+        /**
+         * @brief Creates a handle to an already compiled pipeline.
+        */
+        static Async_pipeline from_pipeline(const Pipeline& pipeline);
+
+        bool valid() const { return m_future.valid(); }
+
+        /**
+         * @brief Returns whether or not the pipeline finished compiling, without blocking.
+        */
+        bool is_ready() const;
+
+        /**
+         * @brief Blocks until the pipeline finished compiling and returns it.
+        */
+        const Pipeline& wait() const { return m_future.get(); }
+
+    private:
+        std::shared_future<Pipeline> m_future = {};
+    };
+
+    /**
+     * @brief Compiles pipelines on worker threads.
+     * @details All pipelines are compiled against the same `VkPipelineCache`, which is internally synchronized
+     * by the driver. The infos are copied, but the shader modules and layouts they reference must stay alive
+     * until the pipeline is ready. Pending compilations are finished on destruction.
+     * Pipelines compiled here are not owned by the compiler, use `Pipeline_state_cache` to share them.
+    */
+    class Pipeline_compiler
+    {
+    public:
+        /**
+         * @param library_cache Optional, graphics pipelines are linked from its library parts if given.
+         * Must outlive the compiler.
+         * @param thread_count The amount of worker threads. If zero, one thread per hardware thread is used.
+        */
+        Pipeline_compiler(VkDevice device, VkPipelineCache pipeline_cache,
+            Pipeline_library_cache* library_cache = nullptr, uint32_t thread_count = 0);
+
+        Pipeline_compiler(const Pipeline_compiler& other) = delete;
+        Pipeline_compiler& operator=(const Pipeline_compiler& other) = delete;
+
+        Async_pipeline compile_graphics_pipeline(Graphics_pipeline_info info);
+        Async_pipeline compile_compute_pipeline(Compute_pipeline_info info);
+
+        uint32_t thread_count() const { return m_thread_pool.thread_count(); }
+
+    private:
+        VkDevice m_device;
+        VkPipelineCache m_pipeline_cache;
+        Pipeline_library_cache* m_library_cache;
+        thread::Thread_pool m_thread_pool;
+    };
+}
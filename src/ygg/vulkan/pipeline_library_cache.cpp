@@ -0,0 +1,134 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/vulkan/pipeline_library_cache.h"
+
+#include "ygg/common/hash.h"
+#include "ygg/vulkan/pipeline_state_key.h"
+
+#include <cassert>
+#include <volk.h>
+
+namespace ygg::vk
+{
+    Pipeline_library_cache::Pipeline_library_cache(VkDevice device, VkPipelineCache pipeline_cache)
+        : m_device(device), m_pipeline_cache(pipeline_cache)
+    {}
+
+    Pipeline_library_cache::~Pipeline_library_cache()
+    {
+        for (auto& [library, entry] : m_libraries) {
+            vkDestroyPipeline(m_device, library, nullptr);
+        }
+    }
+
+    VkPipeline Pipeline_library_cache::create_graphics_pipeline(const Graphics_pipeline_info& info)
+    {
+        constexpr std::array<VkGraphicsPipelineLibraryFlagsEXT, PART_COUNT> parts = {
+            VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+            VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+            VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+            VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT
+        };
+        std::array<VkPipeline, PART_COUNT> libraries = {};
+        for (std::size_t i = 0; i < PART_COUNT; i++) {
+            libraries[i] = acquire_library(info, parts[i]);
+        }
+
+        // Library flags must not be passed on to the linked pipeline.
+        auto pipeline = link_graphics_pipeline(m_device, libraries, info.layout,
+            info.flags & ~VkPipelineCreateFlags(VK_PIPELINE_CREATE_LIBRARY_BIT_KHR), m_pipeline_cache);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_statistics.links++;
+        m_linked_pipelines.emplace(pipeline, libraries);
+        return pipeline;
+    }
+
+    void Pipeline_library_cache::release_graphics_pipeline(VkPipeline pipeline)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_linked_pipelines.find(pipeline);
+        if (it == m_linked_pipelines.end()) {
+            return;
+        }
+        for (auto library : it->second) {
+            release_library(library);
+        }
+        m_linked_pipelines.erase(it);
+    }
+
+    std::size_t Pipeline_library_cache::library_count() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_libraries.size();
+    }
+
+    Pipeline_library_cache_statistics Pipeline_library_cache::statistics() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_statistics;
+    }
+
+    VkPipeline Pipeline_library_cache::acquire_library(const Graphics_pipeline_info& info,
+        VkGraphicsPipelineLibraryFlagsEXT part)
+    {
+        auto state = serialize_pipeline_state(info, part);
+        uint64_t key = hash::fnv_1a_64(state.data(), state.size());
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (auto library = find_library(key, state); library != nullptr) {
+                return library;
+            }
+        }
+
+        auto library = create_graphics_pipeline_library(m_device, info, part, m_pipeline_cache);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Another thread may have compiled the same part in the meantime.
+        if (auto existing = find_library(key, state); existing != nullptr) {
+            vkDestroyPipeline(m_device, library, nullptr);
+            return existing;
+        }
+        m_statistics.library_misses++;
+        m_libraries.emplace(library, Library_entry{
+            .key = key,
+            .references = 1,
+            .state = std::move(state)
+            });
+        m_lookup.emplace(key, library);
+        return library;
+    }
+
+    VkPipeline Pipeline_library_cache::find_library(uint64_t key, const std::vector<uint8_t>& state)
+    {
+        auto [first, last] = m_lookup.equal_range(key);
+        for (auto it = first; it != last; ++it) {
+            auto& entry = m_libraries.at(it->second);
+            if (entry.state == state) {
+                entry.references++;
+                m_statistics.library_hits++;
+                return it->second;
+            }
+        }
+        return nullptr;
+    }
+
+    void Pipeline_library_cache::release_library(VkPipeline library)
+    {
+        auto it = m_libraries.find(library);
+        assert(it != m_libraries.end() && "Releasing a pipeline library that is not owned by the cache.");
+        if (--it->second.references > 0) {
+            return;
+        }
+        auto [first, last] = m_lookup.equal_range(it->second.key);
+        for (auto lookup = first; lookup != last; ++lookup) {
+            if (lookup->second == library) {
+                m_lookup.erase(lookup);
+                break;
+            }
+        }
+        // Linked pipelines don't depend on their libraries, so this is safe while they are in use.
+        vkDestroyPipeline(m_device, library, nullptr);
+        m_libraries.erase(it);
+    }
+}
@@ -0,0 +1,91 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include "ygg/vulkan/resource.h"
+#include "ygg/vulkan/vk_forward_decl.h"
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace ygg::vk
+{
+    struct Pipeline_library_cache_statistics
+    {
+        /**
+         * Library parts that were reused instead of compiled.
+        */
+        uint64_t library_hits;
+
+        /**
+         * Library parts that were compiled.
+        */
+        uint64_t library_misses;
+
+        /**
+         * Pipelines linked from libraries.
+        */
+        uint64_t links;
+    };
+
+    /**
+     * @brief Creates graphics pipelines by fast-linking cached VK_EXT_graphics_pipeline_library parts.
+     * @details A graphics pipeline is split into its vertex input, pre-rasterization, fragment shader and
+     * fragment output parts. Each part is compiled once per distinct state and cached independently, so
+     * permutations of e.g. blend or vertex input state only cost the link instead of a full shader compilation.
+     * Linking is done without link time optimization.
+     * Every linked pipeline holds a reference to its parts, which are destroyed once the last pipeline linked
+     * from them is released. The linked pipelines themselves are owned by the caller.
+     * All functions are internally synchronized, parts are compiled outside of the lock. If multiple threads
+     * compile the same part, only one of them is kept.
+    */
+    class Pipeline_library_cache
+    {
+    public:
+        Pipeline_library_cache(VkDevice device, VkPipelineCache pipeline_cache);
+        ~Pipeline_library_cache();
+
+        Pipeline_library_cache(const Pipeline_library_cache& other) = delete;
+        Pipeline_library_cache& operator=(const Pipeline_library_cache& other) = delete;
+
+        /**
+         * @brief Links a pipeline from the parts matching the info, compiling missing parts.
+        */
+        VkPipeline create_graphics_pipeline(const Graphics_pipeline_info& info);
+
+        /**
+         * @brief Releases the references of a linked pipeline to its parts. Must be called before or
+         * after destroying the pipeline. Pipelines not linked by this cache are ignored.
+        */
+        void release_graphics_pipeline(VkPipeline pipeline);
+
+        std::size_t library_count() const;
+        Pipeline_library_cache_statistics statistics() const;
+
+    private:
+        constexpr static std::size_t PART_COUNT = 4;
+
+        struct Library_entry
+        {
+            uint64_t key;
+            uint32_t references;
+            std::vector<uint8_t> state;
+        };
+
+        VkPipeline acquire_library(const Graphics_pipeline_info& info, VkGraphicsPipelineLibraryFlagsEXT part);
+        VkPipeline find_library(uint64_t key, const std::vector<uint8_t>& state);
+        void release_library(VkPipeline library);
+
+    private:
+        VkDevice m_device;
+        VkPipelineCache m_pipeline_cache;
+        mutable std::mutex m_mutex;
+        std::unordered_map<VkPipeline, Library_entry> m_libraries = {};
+        std::unordered_multimap<uint64_t, VkPipeline> m_lookup = {};
+        std::unordered_map<VkPipeline, std::array<VkPipeline, PART_COUNT>> m_linked_pipelines = {};
+        Pipeline_library_cache_statistics m_statistics = {};
+    };
+}
@@ -0,0 +1,202 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/vulkan/pipeline_state_cache.h"
+
+#include "ygg/common/hash.h"
+#include "ygg/vulkan/pipeline_state_key.h"
+
+#include <cassert>
+#include <volk.h>
+
+namespace ygg::vk
+{
+    Pipeline_state_cache::Pipeline_state_cache(VkDevice device, VkPipelineCache pipeline_cache,
+        Pipeline_library_cache* library_cache)
+        : m_device(device), m_pipeline_cache(pipeline_cache), m_library_cache(library_cache)
+    {}
+
+    Pipeline_state_cache::~Pipeline_state_cache()
+    {
+        for (auto& entry : m_pending_pipelines) {
+            entry.pipeline.wait();
+        }
+        collect_pipelines();
+        for (auto& [pipeline, entry] : m_pipelines) {
+            if (m_library_cache != nullptr) {
+                m_library_cache->release_graphics_pipeline(pipeline);
+            }
+            destroy_pipeline(m_device, entry.pipeline);
+        }
+    }
+
+    Pipeline Pipeline_state_cache::acquire_graphics_pipeline(const Graphics_pipeline_info& info)
+    {
+        collect_pipelines();
+        auto state = serialize_pipeline_state(info);
+        uint64_t key = hash::fnv_1a_64(state.data(), state.size());
+        if (auto pipeline = find_pipeline(key, state); pipeline != nullptr) {
+            return *pipeline;
+        }
+        if (auto pending = find_pending_pipeline(key, state); pending.has_value()) {
+            Pipeline result = pending->wait();
+            collect_pipelines();
+            return result;
+        }
+        m_statistics.misses++;
+        Pipeline result = {
+            .handle = compile_graphics_pipeline(info),
+            .bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS
+        };
+        insert_pipeline(key, std::move(state), result, 1);
+        return result;
+    }
+
+    Pipeline Pipeline_state_cache::acquire_compute_pipeline(const Compute_pipeline_info& info)
+    {
+        collect_pipelines();
+        auto state = serialize_pipeline_state(info);
+        uint64_t key = hash::fnv_1a_64(state.data(), state.size());
+        if (auto pipeline = find_pipeline(key, state); pipeline != nullptr) {
+            return *pipeline;
+        }
+        if (auto pending = find_pending_pipeline(key, state); pending.has_value()) {
+            Pipeline result = pending->wait();
+            collect_pipelines();
+            return result;
+        }
+        m_statistics.misses++;
+        Pipeline result = {
+            .handle = create_compute_pipeline(m_device, info, m_pipeline_cache),
+            .bind_point = VK_PIPELINE_BIND_POINT_COMPUTE
+        };
+        insert_pipeline(key, std::move(state), result, 1);
+        return result;
+    }
+
+    Async_pipeline Pipeline_state_cache::acquire_graphics_pipeline_async(const Graphics_pipeline_info& info,
+        Pipeline_compiler& compiler)
+    {
+        collect_pipelines();
+        auto state = serialize_pipeline_state(info);
+        uint64_t key = hash::fnv_1a_64(state.data(), state.size());
+        if (auto pipeline = find_pipeline(key, state); pipeline != nullptr) {
+            return Async_pipeline::from_pipeline(*pipeline);
+        }
+        if (auto pending = find_pending_pipeline(key, state); pending.has_value()) {
+            return pending.value();
+        }
+        m_statistics.misses++;
+        auto result = compiler.compile_graphics_pipeline(info);
+        m_pending_pipelines.push_back({
+            .key = key,
+            .references = 1,
+            .pipeline = result,
+            .state = std::move(state)
+            });
+        return result;
+    }
+
+    Async_pipeline Pipeline_state_cache::acquire_compute_pipeline_async(const Compute_pipeline_info& info,
+        Pipeline_compiler& compiler)
+    {
+        collect_pipelines();
+        auto state = serialize_pipeline_state(info);
+        uint64_t key = hash::fnv_1a_64(state.data(), state.size());
+        if (auto pipeline = find_pipeline(key, state); pipeline != nullptr) {
+            return Async_pipeline::from_pipeline(*pipeline);
+        }
+        if (auto pending = find_pending_pipeline(key, state); pending.has_value()) {
+            return pending.value();
+        }
+        m_statistics.misses++;
+        auto result = compiler.compile_compute_pipeline(info);
+        m_pending_pipelines.push_back({
+            .key = key,
+            .references = 1,
+            .pipeline = result,
+            .state = std::move(state)
+            });
+        return result;
+    }
+
+    void Pipeline_state_cache::collect_pipelines()
+    {
+        for (auto it = m_pending_pipelines.begin(); it != m_pending_pipelines.end();) {
+            if (!it->pipeline.is_ready()) {
+                ++it;
+                continue;
+            }
+            insert_pipeline(it->key, std::move(it->state), it->pipeline.wait(), it->references);
+            it = m_pending_pipelines.erase(it);
+        }
+    }
+
+    bool Pipeline_state_cache::release_pipeline(const Pipeline& pipeline)
+    {
+        collect_pipelines();
+        auto it = m_pipelines.find(pipeline.handle);
+        assert(it != m_pipelines.end() && "Releasing a pipeline that is not owned by the cache or still pending.");
+        if (--it->second.references > 0) {
+            return false;
+        }
+        auto [first, last] = m_lookup.equal_range(it->second.key);
+        for (auto lookup = first; lookup != last; ++lookup) {
+            if (lookup->second == pipeline.handle) {
+                m_lookup.erase(lookup);
+                break;
+            }
+        }
+        m_pipelines.erase(it);
+        if (m_library_cache != nullptr) {
+            m_library_cache->release_graphics_pipeline(pipeline.handle);
+        }
+        return true;
+    }
+
+    VkPipeline Pipeline_state_cache::compile_graphics_pipeline(const Graphics_pipeline_info& info)
+    {
+        if (m_library_cache != nullptr) {
+            return m_library_cache->create_graphics_pipeline(info);
+        }
+        return create_graphics_pipeline(m_device, info, m_pipeline_cache);
+    }
+
+    Pipeline* Pipeline_state_cache::find_pipeline(uint64_t key, const std::vector<uint8_t>& state)
+    {
+        auto [first, last] = m_lookup.equal_range(key);
+        for (auto it = first; it != last; ++it) {
+            auto& entry = m_pipelines.at(it->second);
+            if (entry.state == state) {
+                entry.references++;
+                m_statistics.hits++;
+                return &entry.pipeline;
+            }
+        }
+        return nullptr;
+    }
+
+    std::optional<Async_pipeline> Pipeline_state_cache::find_pending_pipeline(uint64_t key,
+        const std::vector<uint8_t>& state)
+    {
+        for (auto& entry : m_pending_pipelines) {
+            if (entry.key == key && entry.state == state) {
+                entry.references++;
+                m_statistics.hits++;
+                return entry.pipeline;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void Pipeline_state_cache::insert_pipeline(uint64_t key, std::vector<uint8_t>&& state, const Pipeline& pipeline,
+        uint32_t references)
+    {
+        m_pipelines.emplace(pipeline.handle, Pipeline_entry{
+            .key = key,
+            .references = references,
+            .pipeline = pipeline,
+            .state = std::move(state)
+            });
+        m_lookup.emplace(key, pipeline.handle);
+    }
+}
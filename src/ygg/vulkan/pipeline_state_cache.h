@@ -0,0 +1,129 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include "ygg/vulkan/pipeline_compiler.h"
+#include "ygg/vulkan/pipeline_library_cache.h"
+#include "ygg/vulkan/resource.h"
+#include "ygg/vulkan/vk_forward_decl.h"
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace ygg::vk
+{
+    struct Pipeline_state_cache_statistics
+    {
+        /**
+         * Requests that returned an existing pipeline.
+        */
+        uint64_t hits;
+
+        /**
+         * Requests that created a new pipeline.
+        */
+        uint64_t misses;
+    };
+
+    /**
+     * @brief Deduplicating cache for graphics and compute pipelines.
+     * @details Pipelines are keyed on their full state: the shader modules, every sub-state, the render target
+     * formats, the layout and the specialization constants. Requesting a pipeline equal to an existing one
+     * returns the existing `Pipeline` without calling into the driver.
+     * Shader modules are compared by the hash of their SPIR-V, so equal programs share a pipeline and a module
+     * created with the handle of a destroyed one never matches its pipelines. Layouts are compared by handle,
+     * the layout cache of the `Context` makes equal layouts handle-equal already.
+     * Every request adds a reference that must be released again. Released pipelines are removed from the
+     * cache and must be destroyed by the caller, see `Layout_cache`.
+     * Pipelines can be compiled asynchronously by a `Pipeline_compiler`. Pending pipelines are deduplicated
+     * as well, requesting a pending state shares the pending compilation.
+     * If a `Pipeline_library_cache` is given, graphics pipelines are linked from cached library parts.
+     * Pipelines still referenced on destruction of the cache are destroyed with it, pending ones are awaited first.
+     * All functions must be externally synchronized.
+    */
+    class Pipeline_state_cache
+    {
+    public:
+        /**
+         * @param library_cache Optional, must outlive the cache.
+        */
+        Pipeline_state_cache(VkDevice device, VkPipelineCache pipeline_cache,
+            Pipeline_library_cache* library_cache = nullptr);
+        ~Pipeline_state_cache();
+
+        Pipeline_state_cache(const Pipeline_state_cache& other) = delete;
+        Pipeline_state_cache& operator=(const Pipeline_state_cache& other) = delete;
+
+        /**
+         * @brief Returns a pipeline matching the info and adds a reference to it.
+        */
+        Pipeline acquire_graphics_pipeline(const Graphics_pipeline_info& info);
+
+        /**
+         * @brief Returns a pipeline matching the info and adds a reference to it.
+        */
+        Pipeline acquire_compute_pipeline(const Compute_pipeline_info& info);
+
+        /**
+         * @brief Returns a pipeline matching the info and adds a reference to it.
+         * @details Pipelines not in the cache are compiled by the compiler, the returned handle can be polled.
+         * The compiler must outlive the compilation, see `Pipeline_compiler`.
+        */
+        Async_pipeline acquire_graphics_pipeline_async(const Graphics_pipeline_info& info, Pipeline_compiler& compiler);
+
+        /**
+         * @brief Returns a pipeline matching the info and adds a reference to it, see `acquire_graphics_pipeline_async`.
+        */
+        Async_pipeline acquire_compute_pipeline_async(const Compute_pipeline_info& info, Pipeline_compiler& compiler);
+
+        /**
+         * @brief Moves pipelines that finished compiling into the cache, without blocking.
+         * @details This is done by every acquire and release as well.
+        */
+        void collect_pipelines();
+
+        /**
+         * @brief Releases a reference to the pipeline. Pending pipelines must be awaited before they can be released.
+         * @return Whether or not the last reference was released. The pipeline is then removed from the cache
+         * and must be destroyed by the caller.
+        */
+        bool release_pipeline(const Pipeline& pipeline);
+
+        std::size_t pipeline_count() const { return m_pipelines.size(); }
+        std::size_t pending_pipeline_count() const { return m_pending_pipelines.size(); }
+        const Pipeline_state_cache_statistics& statistics() const { return m_statistics; }
+
+    private:
+        struct Pipeline_entry
+        {
+            uint64_t key;
+            uint32_t references;
+            Pipeline pipeline;
+            std::vector<uint8_t> state;
+        };
+
+        struct Pending_pipeline_entry
+        {
+            uint64_t key;
+            uint32_t references;
+            Async_pipeline pipeline;
+            std::vector<uint8_t> state;
+        };
+
+        VkPipeline compile_graphics_pipeline(const Graphics_pipeline_info& info);
+        Pipeline* find_pipeline(uint64_t key, const std::vector<uint8_t>& state);
+        std::optional<Async_pipeline> find_pending_pipeline(uint64_t key, const std::vector<uint8_t>& state);
+        void insert_pipeline(uint64_t key, std::vector<uint8_t>&& state, const Pipeline& pipeline, uint32_t references);
+
+    private:
+        VkDevice m_device;
+        VkPipelineCache m_pipeline_cache;
+        Pipeline_library_cache* m_library_cache;
+        std::unordered_map<VkPipeline, Pipeline_entry> m_pipelines = {};
+        std::unordered_multimap<uint64_t, VkPipeline> m_lookup = {};
+        std::vector<Pending_pipeline_entry> m_pending_pipelines = {};
+        Pipeline_state_cache_statistics m_statistics = {};
+    };
+}
@@ -0,0 +1,227 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/vulkan/pipeline_state_key.h"
+
+#include <cstring>
+#include <type_traits>
+#include <volk.h>
+
+namespace ygg::vk
+{
+    /**
+     * @brief Serializes pipeline state field by field into a byte string.
+     * @details Structs are never written as a whole, so padding bytes can't make equal states compare unequal.
+     * Optional states and arrays are prefixed with their presence or size, so different layouts of the same
+     * bytes can't collide.
+    */
+    class Pipeline_state_writer
+    {
+    public:
+        template<typename T>
+        requires std::is_trivially_copyable_v<T>
+        void write(const T& value)
+        {
+            if constexpr (std::is_same_v<T, bool>) {
+                m_state.push_back(value ? 1 : 0);
+            }
+            else {
+                auto size = m_state.size();
+                m_state.resize(size + sizeof(T));
+                memcpy(&m_state[size], &value, sizeof(T));
+            }
+        }
+
+        void write_bytes(const void* data, std::size_t size)
+        {
+            write(size);
+            auto offset = m_state.size();
+            m_state.resize(offset + size);
+            if (size > 0) {
+                memcpy(&m_state[offset], data, size);
+            }
+        }
+
+        void write_shader_module(const Shader_module& module)
+        {
+            // Handles can be reused by a different module after destruction, the entry point is always `main`.
+            write(module.spirv_hash);
+            write(module.stage);
+        }
+
+        void write_shader_module(const std::optional<Shader_module>& module)
+        {
+            write(module.has_value());
+            if (module.has_value()) {
+                write_shader_module(module.value());
+            }
+        }
+
+        void write_specialization(const Specialization_info& info)
+        {
+            write(info.entries().size());
+            for (const auto& entry : info.entries()) {
+                write(entry.constant_id);
+                write(entry.offset);
+                write(entry.size);
+            }
+            write_bytes(info.data().data(), info.data().size());
+        }
+
+        void write_stencil_op_state(const Graphics_pipeline_stencil_op_state& state)
+        {
+            write(state.fail_op);
+            write(state.pass_op);
+            write(state.depth_fail_op);
+            write(state.compare_op);
+            write(state.compare_mask);
+            write(state.write_mask);
+            write(state.reference);
+        }
+
+        std::vector<uint8_t>& state() { return m_state; }
+
+    private:
+        std::vector<uint8_t> m_state = {};
+    };
+
+    std::vector<uint8_t> serialize_pipeline_state(const Graphics_pipeline_info& info,
+        VkGraphicsPipelineLibraryFlagsEXT parts)
+    {
+        auto has_part = [parts](VkGraphicsPipelineLibraryFlagsEXT part) {
+            return parts == 0 || (parts & part) != 0;
+        };
+
+        Pipeline_state_writer writer = {};
+        writer.write(VK_PIPELINE_BIND_POINT_GRAPHICS);
+        writer.write(parts);
+        writer.write(info.flags);
+
+        if (has_part(VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT)) {
+            writer.write(info.vertex_input_state.has_value());
+            if (info.vertex_input_state.has_value()) {
+                const auto& vertex_input = info.vertex_input_state.value();
+                writer.write(vertex_input.bindings.size());
+                for (const auto& binding : vertex_input.bindings) {
+                    writer.write(binding.binding);
+                    writer.write(binding.stride);
+                    writer.write(binding.input_rate);
+                }
+                writer.write(vertex_input.attribute_descriptions.size());
+                for (const auto& attribute : vertex_input.attribute_descriptions) {
+                    writer.write(attribute.location);
+                    writer.write(attribute.binding);
+                    writer.write(attribute.format);
+                    writer.write(attribute.offset);
+                }
+            }
+            writer.write(info.input_assembly_state.topology);
+            writer.write(info.input_assembly_state.primitive_restart_enable);
+        }
+
+        if (has_part(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT)) {
+            writer.write_shader_module(info.program.vert);
+            writer.write_shader_module(info.program.tesc);
+            writer.write_shader_module(info.program.tese);
+            writer.write_shader_module(info.program.geom);
+            writer.write_specialization(info.specialization.vert);
+            writer.write_specialization(info.specialization.tesc);
+            writer.write_specialization(info.specialization.tese);
+            writer.write_specialization(info.specialization.geom);
+
+            const auto& raster = info.raster_state;
+            writer.write(raster.depth_clamp_enable);
+            writer.write(raster.rasterizer_discard_enable);
+            writer.write(raster.polygon_mode);
+            writer.write(raster.cull_mode);
+            writer.write(raster.front_face);
+            writer.write(raster.depth_bias_enable);
+            writer.write(raster.depth_bias_constant_factor);
+            writer.write(raster.depth_bias_clamp);
+            writer.write(raster.depth_bias_slope_factor);
+            writer.write(raster.line_width);
+
+            writer.write(info.tesselation_state.has_value());
+            if (info.tesselation_state.has_value()) {
+                writer.write(info.tesselation_state->patch_control_points);
+                writer.write(info.tesselation_state->domain_origin);
+            }
+        }
+
+        if (has_part(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT)) {
+            writer.write_shader_module(info.program.frag);
+            writer.write_specialization(info.specialization.frag);
+
+            writer.write(info.depth_stencil_state.has_value());
+            if (info.depth_stencil_state.has_value()) {
+                const auto& depth_stencil = info.depth_stencil_state.value();
+                writer.write(depth_stencil.depth_test_enable);
+                writer.write(depth_stencil.depth_write_enable);
+                writer.write(depth_stencil.compare_op);
+                writer.write(depth_stencil.depth_bounds_test_enable);
+                writer.write(depth_stencil.stencil_test_enable);
+                writer.write_stencil_op_state(depth_stencil.front);
+                writer.write_stencil_op_state(depth_stencil.back);
+                writer.write(depth_stencil.min_depth_bounds);
+                writer.write(depth_stencil.max_depth_bounds);
+            }
+        }
+
+        if (has_part(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT)) {
+            writer.write(info.color_blend_state.has_value());
+            if (info.color_blend_state.has_value()) {
+                const auto& color_blend = info.color_blend_state.value();
+                writer.write(color_blend.logic_op_enable);
+                writer.write(color_blend.logic_op);
+                for (auto constant : color_blend.blend_constants) {
+                    writer.write(constant);
+                }
+            }
+
+            writer.write(info.render_target_infos.size());
+            for (const auto& target : info.render_target_infos) {
+                writer.write(target.blend_enable);
+                writer.write(target.src_color_blend_factor);
+                writer.write(target.dst_color_blend_factor);
+                writer.write(target.color_blend_op);
+                writer.write(target.src_alpha_blend_factor);
+                writer.write(target.dst_alpha_blend_factor);
+                writer.write(target.alpha_blend_op);
+                writer.write(target.color_write_mask);
+                writer.write(target.format);
+            }
+        }
+
+        // The attachment formats are part of the rendering info, which every part but the vertex input uses.
+        if (has_part(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT |
+            VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT |
+            VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT)) {
+            writer.write(info.depth_stencil_state.has_value());
+            if (info.depth_stencil_state.has_value()) {
+                writer.write(info.depth_stencil_state->depth_format);
+                writer.write(info.depth_stencil_state->stencil_format);
+            }
+            writer.write(info.render_target_infos.size());
+            for (const auto& target : info.render_target_infos) {
+                writer.write(target.format);
+            }
+        }
+
+        writer.write_bytes(info.dynamic_states.data(), info.dynamic_states.size() * sizeof(VkDynamicState));
+        if (has_part(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT |
+            VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT)) {
+            writer.write(info.layout);
+        }
+        return std::move(writer.state());
+    }
+
+    std::vector<uint8_t> serialize_pipeline_state(const Compute_pipeline_info& info)
+    {
+        Pipeline_state_writer writer = {};
+        writer.write(VK_PIPELINE_BIND_POINT_COMPUTE);
+        writer.write(info.flags);
+        writer.write_shader_module(info.shader);
+        writer.write(info.layout);
+        writer.write_specialization(info.specialization);
+        return std::move(writer.state());
+    }
+}
@@ -0,0 +1,26 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include "ygg/vulkan/resource.h"
+#include "ygg/vulkan/vk_forward_decl.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ygg::vk
+{
+    /**
+     * @brief Serializes the state of a graphics pipeline into a byte string that compares equal for equal states.
+     * @details Shader modules are serialized by the hash of their code and layouts by handle.
+     * @param parts The graphics pipeline library parts whose state is serialized. Zero serializes the state of
+     * a complete pipeline. Keys of different parts never compare equal.
+    */
+    std::vector<uint8_t> serialize_pipeline_state(const Graphics_pipeline_info& info,
+        VkGraphicsPipelineLibraryFlagsEXT parts = 0);
+
+    /**
+     * @brief Serializes the state of a compute pipeline, see the graphics overload.
+    */
+    std::vector<uint8_t> serialize_pipeline_state(const Compute_pipeline_info& info);
+}
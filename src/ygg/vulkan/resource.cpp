@@ -2,6 +2,7 @@
 
 #include "ygg/vulkan/resource.h"
 
+#include "ygg/common/hash.h"
 #include "ygg/vulkan/image_utils.h"
 
 #include <cassert>
@@ -261,7 +262,8 @@ namespace ygg::vk
         vkCreateShaderModule(device, &info, nullptr, &sh_module);
         return {
             .handle = sh_module,
-            .stage = stage
+            .stage = stage,
+            .spirv_hash = hash::fnv_1a_64(spirv.data(), spirv.size_bytes())
         };
     }
 
@@ -270,7 +272,35 @@ namespace ygg::vk
         vkDestroyShaderModule(device, shader.handle, nullptr);
     }
 
-    VkPipelineShaderStageCreateInfo shader_stage_create_info(VkShaderModule module, VkShaderStageFlagBits stage)
+    /**
+     * @brief Translates the Specialization_info, `entries` and `result` must outlive the pipeline creation.
+     * @return The translated info or `nullptr` if there are no constants.
+    */
+    const VkSpecializationInfo* translate_specialization_info(const Specialization_info& info,
+        std::vector<VkSpecializationMapEntry>& entries, VkSpecializationInfo& result)
+    {
+        if (info.empty()) {
+            return nullptr;
+        }
+        entries.clear();
+        for (const auto& entry : info.entries()) {
+            entries.push_back({
+                .constantID = entry.constant_id,
+                .offset = entry.offset,
+                .size = entry.size
+                });
+        }
+        result = {
+            .mapEntryCount = uint32_t(entries.size()),
+            .pMapEntries = entries.data(),
+            .dataSize = info.data().size(),
+            .pData = info.data().data()
+        };
+        return &result;
+    }
+
+    VkPipelineShaderStageCreateInfo shader_stage_create_info(VkShaderModule module, VkShaderStageFlagBits stage,
+        const VkSpecializationInfo* specialization_info)
     {
         return {
                 .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
@@ -279,28 +309,49 @@ namespace ygg::vk
                 .stage = stage,
                 .module = module,
                 .pName = "main",
-                .pSpecializationInfo = nullptr
+                .pSpecializationInfo = specialization_info
         };
     }
 
-    VkPipeline create_graphics_pipeline(VkDevice device, const Graphics_pipeline_info& info, VkPipelineCache cache)
+    /**
+     * @brief Creates a complete pipeline if `library_parts` is zero, otherwise a library of the given parts.
+    */
+    VkPipeline create_graphics_pipeline_parts(VkDevice device, const Graphics_pipeline_info& info,
+        VkGraphicsPipelineLibraryFlagsEXT library_parts, VkPipelineCache cache)
     {
+        auto has_part = [library_parts](VkGraphicsPipelineLibraryFlagsEXT part) {
+            return library_parts == 0 || (library_parts & part) != 0;
+        };
+        bool vertex_input = has_part(VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT);
+        bool pre_rasterization = has_part(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT);
+        bool fragment_shader = has_part(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT);
+        bool fragment_output = has_part(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT);
+
         uint32_t stage_count = 0;
         std::array<VkPipelineShaderStageCreateInfo, 5> shader_stage_info = {};
-        shader_stage_info[stage_count++] = shader_stage_create_info(info.program.vert.handle, info.program.vert.stage);
-        if (info.program.tese.has_value()) {
-            const auto& tese = info.program.tese.value();
-            shader_stage_info[stage_count++] = shader_stage_create_info(tese.handle, tese.stage);
-        }
-        if (info.program.tesc.has_value()) {
-            const auto& tesc = info.program.tesc.value();
-            shader_stage_info[stage_count++] = shader_stage_create_info(tesc.handle, tesc.stage);
+        std::array<std::vector<VkSpecializationMapEntry>, 5> specialization_entries = {};
+        std::array<VkSpecializationInfo, 5> specialization_infos = {};
+        auto push_stage = [&](const Shader_module& shader, const Specialization_info& specialization) {
+            auto vk_specialization = translate_specialization_info(specialization,
+                specialization_entries[stage_count], specialization_infos[stage_count]);
+            shader_stage_info[stage_count] = shader_stage_create_info(shader.handle, shader.stage, vk_specialization);
+            stage_count++;
+        };
+        if (pre_rasterization) {
+            push_stage(info.program.vert, info.specialization.vert);
+            if (info.program.tese.has_value()) {
+                push_stage(info.program.tese.value(), info.specialization.tese);
+            }
+            if (info.program.tesc.has_value()) {
+                push_stage(info.program.tesc.value(), info.specialization.tesc);
+            }
+            if (info.program.geom.has_value()) {
+                push_stage(info.program.geom.value(), info.specialization.geom);
+            }
         }
-        if (info.program.geom.has_value()) {
-            const auto& geom = info.program.geom.value();
-            shader_stage_info[stage_count++] = shader_stage_create_info(geom.handle, geom.stage);
+        if (fragment_shader) {
+            push_stage(info.program.frag, info.specialization.frag);
         }
-        shader_stage_info[stage_count++] = shader_stage_create_info(info.program.frag.handle, info.program.frag.stage);
 
         uint32_t vertex_binding_description_count = 0;
         std::array<VkVertexInputBindingDescription, 32> vertex_binding_descriptions = {};
@@ -489,39 +540,86 @@ namespace ygg::vk
                 : VK_FORMAT_UNDEFINED
         };
 
+        VkGraphicsPipelineLibraryCreateInfoEXT library_info = {
+            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+            .pNext = (info.render_target_infos.size() > 0) ? &dynamic_rendering_info : nullptr,
+            .flags = library_parts
+        };
+
         VkGraphicsPipelineCreateInfo create_info = {
             .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-            .pNext = (info.render_target_infos.size() > 0) ? &dynamic_rendering_info : nullptr,
-            .flags = info.flags,
+            .pNext = (library_parts != 0) ? &library_info : library_info.pNext,
+            .flags = (library_parts != 0) ? (info.flags | VK_PIPELINE_CREATE_LIBRARY_BIT_KHR) : info.flags,
             .stageCount = stage_count,
             .pStages = shader_stage_info.data(),
-            .pVertexInputState = &vertex_input_state_info,
-            .pInputAssemblyState = &input_assembly_info,
-            .pTessellationState = info.tesselation_state.has_value() ? &tesselation_info : nullptr,
-            .pViewportState = &viewport_state,
-            .pRasterizationState = &raster_info,
-            .pMultisampleState = &multi_sample_state,
-            .pDepthStencilState = info.depth_stencil_state.has_value() ? &depth_stencil_info : nullptr,
-            .pColorBlendState = (info.render_target_infos.size() > 0) ? &color_blend_info : nullptr,
+            .pVertexInputState = vertex_input ? &vertex_input_state_info : nullptr,
+            .pInputAssemblyState = vertex_input ? &input_assembly_info : nullptr,
+            .pTessellationState = (pre_rasterization && info.tesselation_state.has_value()) ? &tesselation_info : nullptr,
+            .pViewportState = pre_rasterization ? &viewport_state : nullptr,
+            .pRasterizationState = pre_rasterization ? &raster_info : nullptr,
+            .pMultisampleState = (fragment_shader || fragment_output) ? &multi_sample_state : nullptr,
+            .pDepthStencilState = (fragment_shader && info.depth_stencil_state.has_value()) ? &depth_stencil_info : nullptr,
+            .pColorBlendState = (fragment_output && info.render_target_infos.size() > 0) ? &color_blend_info : nullptr,
             .pDynamicState = &dynamic_state_create_info,
-            .layout = info.layout,
+            .layout = (pre_rasterization || fragment_shader) ? info.layout : VK_NULL_HANDLE,
+            .renderPass = VK_NULL_HANDLE,
+            .subpass = 0,
+            .basePipelineHandle = VK_NULL_HANDLE,
+            .basePipelineIndex = 0
+        };
+        VkPipeline result = VK_NULL_HANDLE;
+        vkCreateGraphicsPipelines(device, cache, 1, &create_info, nullptr, &result);
+        return result;
+    }
+
+    VkPipeline create_graphics_pipeline(VkDevice device, const Graphics_pipeline_info& info, VkPipelineCache cache)
+    {
+        return create_graphics_pipeline_parts(device, info, 0, cache);
+    }
+
+    VkPipeline create_graphics_pipeline_library(VkDevice device, const Graphics_pipeline_info& info,
+        VkGraphicsPipelineLibraryFlagsEXT parts, VkPipelineCache cache)
+    {
+        assert(parts != 0 && "A pipeline library must contain at least one part.");
+        return create_graphics_pipeline_parts(device, info, parts, cache);
+    }
+
+    VkPipeline link_graphics_pipeline(VkDevice device, std::span<const VkPipeline> libraries, VkPipelineLayout layout,
+        VkPipelineCreateFlags flags, VkPipelineCache cache)
+    {
+        VkPipelineLibraryCreateInfoKHR library_info = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+            .pNext = nullptr,
+            .libraryCount = uint32_t(libraries.size()),
+            .pLibraries = libraries.data()
+        };
+        VkGraphicsPipelineCreateInfo create_info = {
+            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+            .pNext = &library_info,
+            .flags = flags,
+            .layout = layout,
             .renderPass = VK_NULL_HANDLE,
             .subpass = 0,
             .basePipelineHandle = VK_NULL_HANDLE,
             .basePipelineIndex = 0
         };
         VkPipeline result = VK_NULL_HANDLE;
+        // TODO: add VK_CHECK
         vkCreateGraphicsPipelines(device, cache, 1, &create_info, nullptr, &result);
         return result;
     }
 
     VkPipeline create_compute_pipeline(VkDevice device, const Compute_pipeline_info& info, VkPipelineCache cache)
     {
+        std::vector<VkSpecializationMapEntry> specialization_entries = {};
+        VkSpecializationInfo specialization_info = {};
+        auto vk_specialization = translate_specialization_info(info.specialization,
+            specialization_entries, specialization_info);
         VkComputePipelineCreateInfo create_info = {
             .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
             .pNext = nullptr,
             .flags = info.flags,
-            .stage = shader_stage_create_info(info.shader.handle, info.shader.stage),
+            .stage = shader_stage_create_info(info.shader.handle, info.shader.stage, vk_specialization),
             .layout = info.layout,
             .basePipelineHandle = VK_NULL_HANDLE,
             .basePipelineIndex = 0
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "ygg/vulkan/specialization.h"
 #include "ygg/vulkan/vk_forward_decl.h"
 
 #include <array>
@@ -11,6 +12,11 @@
 
 namespace ygg::vk
 {
+    /**
+     * @brief Index of a resource that is not registered in the bindless descriptor heap.
+    */
+    constexpr static uint32_t INVALID_BINDLESS_INDEX = ~0u;
+
     /**
      * @brief Memory domain in which a buffer resides in.
      * @details Buffers with the domain `Device_host_visible` will be buffered
@@ -50,6 +56,7 @@ namespace ygg::vk
     {
         std::array<Allocated_buffer, YGG_MAX_FRAMES_IN_FLIGHT> allocated_buffers;
         Buffer_info info;
+        uint32_t bindless_index = INVALID_BINDLESS_INDEX; // Storage buffer index in the bindless heap.
     };
 
     /**
@@ -99,6 +106,8 @@ namespace ygg::vk
     {
         Allocated_image allocated_image;
         Image_info info;
+        uint32_t bindless_sampled_index = INVALID_BINDLESS_INDEX; // Sampled image index in the bindless heap.
+        uint32_t bindless_storage_index = INVALID_BINDLESS_INDEX; // Storage image index in the bindless heap.
     };
 
     /**
@@ -180,6 +189,7 @@ namespace ygg::vk
     {
         VkShaderModule handle;
         VkShaderStageFlagBits stage;
+        uint64_t spirv_hash; // Identifies the code, handles may be reused once the module is destroyed.
     };
 
     /**
@@ -201,6 +211,19 @@ namespace ygg::vk
         Shader_module frag;
     };
 
+    /**
+     * @brief Specialization constants of every stage of a `Graphics_program`.
+     * @details Stages without constants use their default values.
+    */
+    struct Graphics_program_specialization
+    {
+        Specialization_info vert;
+        Specialization_info tesc;
+        Specialization_info tese;
+        Specialization_info geom;
+        Specialization_info frag;
+    };
+
     /**
      * @brief https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkPipelineColorBlendAttachmentState.html
     */
@@ -344,6 +367,7 @@ namespace ygg::vk
         std::vector<VkDynamicState> dynamic_states; // VK_DYNAMIC_STATE_VIEWPORT and VK_DYNAMIC_STATE_SCISSOR are always set.
         std::vector<Graphics_pipeline_color_attachment_info> render_target_infos;
         VkPipelineLayout layout;
+        Graphics_program_specialization specialization = {};
     };
 
     /**
@@ -354,6 +378,7 @@ namespace ygg::vk
         VkPipelineCreateFlags flags;
         Shader_module shader;
         VkPipelineLayout layout;
+        Specialization_info specialization = {};
     };
 
     /**
@@ -361,6 +386,22 @@ namespace ygg::vk
     */
     VkPipeline create_graphics_pipeline(VkDevice device, const Graphics_pipeline_info& info, VkPipelineCache cache = nullptr);
 
+    /**
+     * @brief Creates a graphics pipeline library containing only the given parts of the pipeline.
+     * @details Requires VK_EXT_graphics_pipeline_library. Only the state belonging to the parts is used.
+     * https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkGraphicsPipelineLibraryCreateInfoEXT.html
+    */
+    VkPipeline create_graphics_pipeline_library(VkDevice device, const Graphics_pipeline_info& info,
+        VkGraphicsPipelineLibraryFlagsEXT parts, VkPipelineCache cache = nullptr);
+
+    /**
+     * @brief Links graphics pipeline libraries into a complete pipeline without link time optimization.
+     * @details The libraries must contain every part of a graphics pipeline exactly once.
+     * https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkPipelineLibraryCreateInfoKHR.html
+    */
+    VkPipeline link_graphics_pipeline(VkDevice device, std::span<const VkPipeline> libraries, VkPipelineLayout layout,
+        VkPipelineCreateFlags flags, VkPipelineCache cache = nullptr);
+
     /**
      * @brief https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/vkCreateComputePipelines.html
     */
@@ -0,0 +1,31 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/vulkan/specialization.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace ygg::vk
+{
+    Specialization_info& Specialization_info::set_bytes(uint32_t constant_id, const void* value, std::size_t size)
+    {
+        for (const auto& entry : m_entries) {
+            if (entry.constant_id == constant_id) {
+                if (entry.size != size) {
+                    assert(false && "Specialization constant type changed.");
+                    return *this;
+                }
+                memcpy(&m_data[entry.offset], value, size);
+                return *this;
+            }
+        }
+        m_entries.push_back({
+            .constant_id = constant_id,
+            .offset = uint32_t(m_data.size()),
+            .size = size
+            });
+        m_data.resize(m_data.size() + size);
+        memcpy(&m_data[m_entries.back().offset], value, size);
+        return *this;
+    }
+}
@@ -0,0 +1,120 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace ygg::vk
+{
+    /**
+     * @brief https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkSpecializationMapEntry.html
+    */
+    struct Specialization_map_entry
+    {
+        uint32_t constant_id;
+        uint32_t offset;
+        std::size_t size;
+    };
+
+    /**
+     * @brief Types that can be used as a specialization constant. `bool` is stored as a 32 bit `VkBool32`.
+    */
+    template<typename T>
+    concept Specialization_constant_type =
+        std::is_same_v<T, bool> ||
+        std::is_same_v<T, int32_t> || std::is_same_v<T, uint32_t> ||
+        std::is_same_v<T, int64_t> || std::is_same_v<T, uint64_t> ||
+        std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+    /**
+     * @brief Map of specialization constant ids to values for a single shader stage.
+     * @details https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VkSpecializationInfo.html
+    */
+    class Specialization_info
+    {
+    public:
+        /**
+         * @brief Sets the value of the specialization constant with the given id.
+         * @details Setting an id again replaces its value, the type must stay the same.
+         * Setting a value of a different size is ignored and the previous value is kept.
+         * @return This instance.
+        */
+        template<Specialization_constant_type T>
+        Specialization_info& set(uint32_t constant_id, T value)
+        {
+            if constexpr (std::is_same_v<T, bool>) {
+                uint32_t vk_bool = value ? 1u : 0u;
+                return set_bytes(constant_id, &vk_bool, sizeof(vk_bool));
+            }
+            else {
+                return set_bytes(constant_id, &value, sizeof(value));
+            }
+        }
+
+        bool empty() const { return m_entries.empty(); }
+        const std::vector<Specialization_map_entry>& entries() const { return m_entries; }
+        const std::vector<uint8_t>& data() const { return m_data; }
+
+    private:
+        Specialization_info& set_bytes(uint32_t constant_id, const void* value, std::size_t size);
+
+    private:
+        std::vector<Specialization_map_entry> m_entries = {};
+        std::vector<uint8_t> m_data = {};
+    };
+
+    /**
+     * @brief A specialization constant with a compile-time id, matching `layout(constant_id = Id)` in the shader.
+    */
+    template<uint32_t Id, Specialization_constant_type T>
+    struct Specialization_constant
+    {
+        constexpr static uint32_t ID = Id;
+        using Value_type = T;
+
+        T value;
+    };
+
+    /**
+     * @brief Struct declaring its specialization constants as `Specialization_constant` members.
+     * @details The struct lists its members with `auto specialization_constants() const { return std::tie(...); }`.
+    */
+    template<typename T>
+    concept Specialization_constant_struct = requires(const T& t) {
+        { t.specialization_constants() };
+    };
+
+    /**
+     * @brief Builds a `Specialization_info` from the given constants.
+    */
+    template<uint32_t... Ids, typename... Ts>
+    Specialization_info make_specialization_info(const Specialization_constant<Ids, Ts>&... constants)
+    {
+        Specialization_info result = {};
+        (result.set(Ids, constants.value), ...);
+        return result;
+    }
+
+    /**
+     * @brief Builds a `Specialization_info` from all constants listed by the struct.
+     * @details Example:
+     * struct Blur_constants
+     * {
+     *     Specialization_constant<0, uint32_t> workgroup_size;
+     *     Specialization_constant<1, uint32_t> tap_count;
+     *     Specialization_constant<2, bool> horizontal;
+     *
+     *     auto specialization_constants() const { return std::tie(workgroup_size, tap_count, horizontal); }
+     * };
+    */
+    template<Specialization_constant_struct T>
+    Specialization_info make_specialization_info(const T& constants)
+    {
+        return std::apply([](const auto&... c) { return make_specialization_info(c...); },
+            constants.specialization_constants());
+    }
+}
@@ -0,0 +1,276 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/vulkan/spirv_cache.h"
+
+#include "ygg/common/file_util.h"
+#include "ygg/common/hash.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <volk.h>
+
+namespace ygg::vk
+{
+    constexpr uint32_t SPIRV_CACHE_MAGIC = 0x56505359; // "YSPV"
+    constexpr uint32_t SPIRV_CACHE_FILE_VERSION = 1;
+
+    struct Spirv_cache_file_header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint32_t include_count;
+        uint32_t spirv_word_count;
+    };
+
+    uint64_t compute_spirv_cache_key(const std::string& code, VkShaderStageFlags shader_stage,
+        std::span<const std::string> include_dirs, std::span<const glsl_compiler::Shader_define> defines)
+    {
+        // Spirv from another compiler build or cache format may differ even if the inputs are identical.
+        static const std::string compiler_version = glsl_compiler::compiler_version();
+        uint64_t key = hash::fnv_1a_64_value(SPIRV_CACHE_FILE_VERSION);
+        key = hash::fnv_1a_64_str(compiler_version, key);
+        key = hash::fnv_1a_64_str(glsl_compiler::TARGET_ENVIRONMENT, key);
+        key = hash::fnv_1a_64_value(shader_stage, key);
+        key = hash::fnv_1a_64_str(code, key);
+        key = hash::fnv_1a_64_value(include_dirs.size(), key);
+        for (const auto& include_dir : include_dirs) {
+            key = hash::fnv_1a_64_str(include_dir, key);
+        }
+        key = hash::fnv_1a_64_value(defines.size(), key);
+        for (const auto& define : defines) {
+            key = hash::fnv_1a_64_str(define.name, key);
+            key = hash::fnv_1a_64_str(define.value, key);
+        }
+        return key;
+    }
+
+    bool read_bytes(const std::vector<uint8_t>& data, std::size_t& offset, void* dst, std::size_t size)
+    {
+        if (data.size() - offset < size) {
+            return false;
+        }
+        memcpy(dst, &data[offset], size);
+        offset += size;
+        return true;
+    }
+
+    void write_bytes(std::vector<uint8_t>& data, const void* src, std::size_t size)
+    {
+        auto bytes = static_cast<const uint8_t*>(src);
+        data.insert(data.end(), bytes, bytes + size);
+    }
+
+    Spirv_cache::Spirv_cache(const std::string& directory)
+        : m_directory(directory)
+    {
+        if (!m_directory.empty()) {
+            std::error_code error = {};
+            std::filesystem::create_directories(m_directory, error);
+            if (error) {
+                printf("Failed to create Spirv cache directory '%s', using in-memory cache only.\n",
+                    m_directory.c_str()); // TODO: logging?
+                m_directory.clear();
+            }
+        }
+    }
+
+    std::vector<uint32_t> Spirv_cache::compile_spirv_1_6(const std::string& code, VkShaderStageFlags shader_stage,
+        std::span<const std::string> include_dirs, std::span<const glsl_compiler::Shader_define> defines)
+    {
+        uint64_t key = compute_spirv_cache_key(code, shader_stage, include_dirs, defines);
+        if (auto entry = find_entry(key)) {
+            return entry->spirv;
+        }
+        return insert_entry(key, glsl_compiler::compile_spirv_1_6(code, shader_stage, include_dirs, defines)).spirv;
+    }
+
+    std::vector<Spirv_cache::Batch_result> Spirv_cache::compile_spirv_1_6_batch(
+        std::span<const glsl_compiler::Compile_job> jobs, glsl_compiler::Batch_compiler& compiler)
+    {
+        struct Pending_job
+        {
+            std::size_t index;
+            uint64_t key;
+            std::future<glsl_compiler::Compile_result> result;
+        };
+
+        std::vector<Batch_result> results(jobs.size());
+        std::vector<Pending_job> pending_jobs = {};
+        for (std::size_t i = 0; i < jobs.size(); i++) {
+            const auto& job = jobs[i];
+            uint64_t key = compute_spirv_cache_key(job.code, job.shader_stage, job.include_dirs, job.defines);
+            if (auto entry = find_entry(key)) {
+                results[i].spirv = entry->spirv;
+                results[i].includes = include_paths(*entry);
+            }
+            else {
+                pending_jobs.push_back({
+                    .index = i,
+                    .key = key,
+                    .result = compiler.compile(job)
+                    });
+            }
+        }
+
+        for (auto& pending_job : pending_jobs) {
+            try {
+                const auto& entry = insert_entry(pending_job.key, pending_job.result.get());
+                results[pending_job.index].spirv = entry.spirv;
+                results[pending_job.index].includes = include_paths(entry);
+            }
+            catch (const glsl_compiler::Glsl_compiler_error& e) {
+                results[pending_job.index].error = e.what();
+            }
+        }
+        return results;
+    }
+
+    std::vector<std::string> Spirv_cache::include_paths(const Entry& entry)
+    {
+        std::vector<std::string> result = {};
+        result.reserve(entry.includes.size());
+        for (const auto& include : entry.includes) {
+            result.push_back(include.path);
+        }
+        return result;
+    }
+
+    const Spirv_cache::Entry* Spirv_cache::find_entry(uint64_t key)
+    {
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            if (is_up_to_date(it->second)) {
+                m_statistics.memory_hits++;
+                return &it->second;
+            }
+            m_statistics.stale_entries++;
+            m_entries.erase(it);
+        }
+        else {
+            Entry entry = {};
+            if (load_entry(key, entry)) {
+                if (is_up_to_date(entry)) {
+                    m_statistics.disk_hits++;
+                    return &m_entries.emplace(key, std::move(entry)).first->second;
+                }
+                m_statistics.stale_entries++;
+            }
+        }
+        m_statistics.misses++;
+        return nullptr;
+    }
+
+    const Spirv_cache::Entry& Spirv_cache::insert_entry(uint64_t key, glsl_compiler::Compile_result&& result)
+    {
+        Entry entry = {
+            .includes = {},
+            .spirv = std::move(result.spirv)
+        };
+        entry.includes.reserve(result.includes.size());
+        for (const auto& include : result.includes) {
+            entry.includes.push_back({
+                .path = include.path,
+                .content_hash = hash::fnv_1a_64(include.content.data(), include.content.size())
+                });
+        }
+        store_entry(key, entry);
+        return m_entries.insert_or_assign(key, std::move(entry)).first->second;
+    }
+
+    void Spirv_cache::clear_memory()
+    {
+        m_entries.clear();
+    }
+
+    bool Spirv_cache::is_up_to_date(const Entry& entry) const
+    {
+        for (const auto& include : entry.includes) {
+            try {
+                auto content = file_util::file_to_bytes(include.path);
+                if (hash::fnv_1a_64(content.data(), content.size()) != include.content_hash) {
+                    return false;
+                }
+            }
+            catch (const file_util::IO_error&) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Spirv_cache::load_entry(uint64_t key, Entry& entry) const
+    {
+        if (m_directory.empty()) {
+            return false;
+        }
+        std::vector<uint8_t> data = {};
+        try {
+            data = file_util::file_to_bytes(entry_path(key));
+        }
+        catch (const file_util::IO_error&) {
+            return false;
+        }
+
+        std::size_t offset = 0;
+        Spirv_cache_file_header header = {};
+        if (!read_bytes(data, offset, &header, sizeof(header)) ||
+            header.magic != SPIRV_CACHE_MAGIC ||
+            header.version != SPIRV_CACHE_FILE_VERSION ||
+            header.key != key) {
+            return false;
+        }
+        entry.includes.resize(header.include_count);
+        for (auto& include : entry.includes) {
+            uint32_t path_length = 0;
+            if (!read_bytes(data, offset, &include.content_hash, sizeof(include.content_hash)) ||
+                !read_bytes(data, offset, &path_length, sizeof(path_length))) {
+                return false;
+            }
+            include.path.resize(path_length);
+            if (!read_bytes(data, offset, include.path.data(), path_length)) {
+                return false;
+            }
+        }
+        entry.spirv.resize(header.spirv_word_count);
+        return read_bytes(data, offset, entry.spirv.data(), entry.spirv.size() * sizeof(uint32_t)) &&
+            offset == data.size();
+    }
+
+    void Spirv_cache::store_entry(uint64_t key, const Entry& entry) const
+    {
+        if (m_directory.empty()) {
+            return;
+        }
+        Spirv_cache_file_header header = {
+            .magic = SPIRV_CACHE_MAGIC,
+            .version = SPIRV_CACHE_FILE_VERSION,
+            .key = key,
+            .include_count = uint32_t(entry.includes.size()),
+            .spirv_word_count = uint32_t(entry.spirv.size())
+        };
+        std::vector<uint8_t> data = {};
+        write_bytes(data, &header, sizeof(header));
+        for (const auto& include : entry.includes) {
+            uint32_t path_length = uint32_t(include.path.size());
+            write_bytes(data, &include.content_hash, sizeof(include.content_hash));
+            write_bytes(data, &path_length, sizeof(path_length));
+            write_bytes(data, include.path.data(), path_length);
+        }
+        write_bytes(data, entry.spirv.data(), entry.spirv.size() * sizeof(uint32_t));
+        try {
+            file_util::bytes_to_file_atomic(entry_path(key), data);
+        }
+        catch (const file_util::IO_error& error) {
+            printf("Failed to store Spirv cache entry: %s\n", error.what()); // TODO: logging?
+        }
+    }
+
+    std::string Spirv_cache::entry_path(uint64_t key) const
+    {
+        char name[32] = {};
+        snprintf(name, sizeof(name), "%016llx.spv", static_cast<unsigned long long>(key));
+        return (std::filesystem::path(m_directory) / name).string();
+    }
+}
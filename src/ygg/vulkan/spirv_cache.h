@@ -0,0 +1,119 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include "ygg/vulkan/glsl_batch_compiler.h"
+#include "ygg/vulkan/glsl_compiler.h"
+#include "ygg/vulkan/vk_forward_decl.h"
+
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ygg::vk
+{
+    struct Spirv_cache_statistics
+    {
+        uint64_t memory_hits;
+        uint64_t disk_hits;
+        uint64_t misses;
+
+        /**
+         * Entries that were found but discarded, because an included file changed.
+         * Also counted as misses.
+        */
+        uint64_t stale_entries;
+    };
+
+    /**
+     * @brief Content addressed cache for compiled Spirv with an in-memory and an on-disk tier.
+     * @details Entries are keyed by a hash of the source code, the shader stage, the target environment,
+     * the include directories and the defines. Every entry stores the files resolved by `#include` while
+     * compiling, together with a hash of their content. On lookup the included files are read and hashed
+     * again and the entry is only used if all of them are unchanged, so a hit always corresponds to the same
+     * preprocessed source. A hit never invokes glslang.
+     * Entries found on disk are promoted to the memory tier, compiled entries are written to both tiers.
+     * All functions must be externally synchronized.
+    */
+    class Spirv_cache
+    {
+    public:
+        struct Batch_result
+        {
+            std::vector<uint32_t> spirv;
+
+            /**
+             * The compiler error message if the job could not compile.
+            */
+            std::optional<std::string> error;
+
+            /**
+             * The files resolved by `#include` while compiling, empty if the job could not compile.
+            */
+            std::vector<std::string> includes;
+        };
+
+        /**
+         * @brief Creates the cache.
+         * @param directory The directory used for the on-disk tier, created if missing.
+         * If empty, only the in-memory tier is used.
+        */
+        explicit Spirv_cache(const std::string& directory);
+
+        Spirv_cache(const Spirv_cache& other) = delete;
+        Spirv_cache& operator=(const Spirv_cache& other) = delete;
+
+        /**
+         * @brief Returns the cached Spirv for the code or compiles it on a miss.
+         * @details This function may throw `glsl_compiler::Glsl_compiler_error` if the code could not compile.
+         * Failed compilations are not cached.
+        */
+        std::vector<uint32_t> compile_spirv_1_6(const std::string& code, VkShaderStageFlags shader_stage,
+            std::span<const std::string> include_dirs = {},
+            std::span<const glsl_compiler::Shader_define> defines = {});
+
+        /**
+         * @brief Returns the cached Spirv for every job and compiles all misses concurrently.
+         * @details Blocks until all misses are compiled. Failed jobs are reported in their result
+         * and not cached, the other jobs are unaffected.
+         * @return One result per job, in the order of the jobs.
+        */
+        std::vector<Batch_result> compile_spirv_1_6_batch(std::span<const glsl_compiler::Compile_job> jobs,
+            glsl_compiler::Batch_compiler& compiler);
+
+        /**
+         * @brief Discards all entries of the in-memory tier. The on-disk tier is kept.
+        */
+        void clear_memory();
+
+        const Spirv_cache_statistics& statistics() const { return m_statistics; }
+
+    private:
+        struct Include_dependency
+        {
+            std::string path;
+            uint64_t content_hash;
+        };
+
+        struct Entry
+        {
+            std::vector<Include_dependency> includes;
+            std::vector<uint32_t> spirv;
+        };
+
+        static std::vector<std::string> include_paths(const Entry& entry);
+        const Entry* find_entry(uint64_t key);
+        const Entry& insert_entry(uint64_t key, glsl_compiler::Compile_result&& result);
+        bool is_up_to_date(const Entry& entry) const;
+        bool load_entry(uint64_t key, Entry& entry) const;
+        void store_entry(uint64_t key, const Entry& entry) const;
+        std::string entry_path(uint64_t key) const;
+
+    private:
+        std::string m_directory;
+        std::unordered_map<uint64_t, Entry> m_entries = {};
+        Spirv_cache_statistics m_statistics = {};
+    };
+}
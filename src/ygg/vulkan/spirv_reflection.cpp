@@ -0,0 +1,602 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/vulkan/spirv_reflection.h"
+
+#include <algorithm>
+#include <cassert>
+#include <volk.h>
+
+namespace ygg::vk
+{
+    /**
+     * @brief The subset of the Spirv specification needed for reflection.
+     * @details https://registry.khronos.org/SPIR-V/specs/unified1/SPIRV.html
+    */
+    namespace spirv_spec
+    {
+        constexpr uint32_t MAGIC_NUMBER = 0x07230203;
+        constexpr uint32_t HEADER_WORD_COUNT = 5;
+        constexpr uint32_t MAX_ID_BOUND = 0x3fffff;
+
+        constexpr uint32_t OP_ENTRY_POINT = 15;
+        constexpr uint32_t OP_EXECUTION_MODE = 16;
+        constexpr uint32_t OP_TYPE_BOOL = 20;
+        constexpr uint32_t OP_TYPE_INT = 21;
+        constexpr uint32_t OP_TYPE_FLOAT = 22;
+        constexpr uint32_t OP_TYPE_VECTOR = 23;
+        constexpr uint32_t OP_TYPE_MATRIX = 24;
+        constexpr uint32_t OP_TYPE_IMAGE = 25;
+        constexpr uint32_t OP_TYPE_SAMPLER = 26;
+        constexpr uint32_t OP_TYPE_SAMPLED_IMAGE = 27;
+        constexpr uint32_t OP_TYPE_ARRAY = 28;
+        constexpr uint32_t OP_TYPE_RUNTIME_ARRAY = 29;
+        constexpr uint32_t OP_TYPE_STRUCT = 30;
+        constexpr uint32_t OP_TYPE_POINTER = 32;
+        constexpr uint32_t OP_CONSTANT = 43;
+        constexpr uint32_t OP_CONSTANT_COMPOSITE = 44;
+        constexpr uint32_t OP_SPEC_CONSTANT = 50;
+        constexpr uint32_t OP_SPEC_CONSTANT_COMPOSITE = 51;
+        constexpr uint32_t OP_VARIABLE = 59;
+        constexpr uint32_t OP_DECORATE = 71;
+        constexpr uint32_t OP_MEMBER_DECORATE = 72;
+        constexpr uint32_t OP_EXECUTION_MODE_ID = 331;
+        constexpr uint32_t OP_TYPE_ACCELERATION_STRUCTURE_KHR = 5341;
+
+        constexpr uint32_t DECORATION_BLOCK = 2;
+        constexpr uint32_t DECORATION_BUFFER_BLOCK = 3;
+        constexpr uint32_t DECORATION_ROW_MAJOR = 4;
+        constexpr uint32_t DECORATION_ARRAY_STRIDE = 6;
+        constexpr uint32_t DECORATION_MATRIX_STRIDE = 7;
+        constexpr uint32_t DECORATION_BUILT_IN = 11;
+        constexpr uint32_t DECORATION_BINDING = 33;
+        constexpr uint32_t DECORATION_DESCRIPTOR_SET = 34;
+        constexpr uint32_t DECORATION_OFFSET = 35;
+
+        constexpr uint32_t BUILT_IN_WORKGROUP_SIZE = 25;
+
+        constexpr uint32_t EXECUTION_MODE_LOCAL_SIZE = 17;
+        constexpr uint32_t EXECUTION_MODE_LOCAL_SIZE_ID = 38;
+
+        constexpr uint32_t STORAGE_CLASS_UNIFORM_CONSTANT = 0;
+        constexpr uint32_t STORAGE_CLASS_UNIFORM = 2;
+        constexpr uint32_t STORAGE_CLASS_PUSH_CONSTANT = 9;
+        constexpr uint32_t STORAGE_CLASS_STORAGE_BUFFER = 12;
+
+        constexpr uint32_t DIM_BUFFER = 5;
+        constexpr uint32_t DIM_SUBPASS_DATA = 6;
+    }
+
+    struct Spirv_member
+    {
+        uint32_t offset = 0;
+        uint32_t matrix_stride = 0;
+        bool row_major = false;
+    };
+
+    struct Spirv_id
+    {
+        uint32_t instruction = 0; // Word index of the instruction defining the id, 0 if undefined.
+        uint32_t descriptor_set = 0;
+        uint32_t binding = 0;
+        uint32_t array_stride = 0;
+        bool has_descriptor_set = false;
+        bool has_binding = false;
+        bool is_buffer_block = false;
+        bool is_workgroup_size = false;
+        std::vector<Spirv_member> members = {};
+    };
+
+    /**
+     * @brief Accessors of the module never read outside of it or the instruction defining an id.
+     * @details Invalid accesses set `has_error` and return 0, which is not a valid id, so the reflection
+     * can continue and fails once done.
+    */
+    struct Spirv_module
+    {
+        std::span<const uint32_t> words;
+        std::vector<Spirv_id> ids;
+        mutable bool has_error = false;
+
+        bool is_id(uint32_t id) const { return id != 0 && id < ids.size(); }
+        bool is_defined(uint32_t id) const { return is_id(id) && ids[id].instruction != 0; }
+
+        uint32_t opcode(uint32_t id) const
+        {
+            if (!is_defined(id)) {
+                has_error = true;
+                return 0;
+            }
+            return words[ids[id].instruction] & 0xffff;
+        }
+
+        uint32_t word_count(uint32_t id) const
+        {
+            if (!is_defined(id)) {
+                has_error = true;
+                return 0;
+            }
+            return words[ids[id].instruction] >> 16;
+        }
+
+        uint32_t operand(uint32_t id, uint32_t index) const
+        {
+            if (index + 1 >= word_count(id)) {
+                has_error = true;
+                return 0;
+            }
+            return words[ids[id].instruction + 1 + index];
+        }
+
+        /**
+         * @brief Returns an operand referring to another id, which must be defined before the instruction.
+         * @details Types and constants can't be forward referenced, so recursing through them always terminates.
+        */
+        uint32_t operand_id(uint32_t id, uint32_t index) const
+        {
+            uint32_t result = operand(id, index);
+            if (!is_defined(result) || ids[result].instruction >= ids[id].instruction) {
+                has_error = true;
+                return 0;
+            }
+            return result;
+        }
+    };
+
+    /**
+     * @return Whether the operands read while gathering the instruction exist and its ids are within the bound.
+    */
+    bool is_gathered_instruction_valid(const Spirv_module& module, uint32_t op, std::span<const uint32_t> operands)
+    {
+        switch (op)
+        {
+        case spirv_spec::OP_ENTRY_POINT:
+            return operands.size() >= 1;
+        case spirv_spec::OP_EXECUTION_MODE:
+        case spirv_spec::OP_EXECUTION_MODE_ID:
+            if (operands.size() < 2) {
+                return false;
+            }
+            if (operands[1] == spirv_spec::EXECUTION_MODE_LOCAL_SIZE ||
+                operands[1] == spirv_spec::EXECUTION_MODE_LOCAL_SIZE_ID) {
+                return operands.size() >= 5;
+            }
+            return true;
+        case spirv_spec::OP_DECORATE:
+            if (operands.size() < 2 || !module.is_id(operands[0])) {
+                return false;
+            }
+            switch (operands[1])
+            {
+            case spirv_spec::DECORATION_ARRAY_STRIDE:
+            case spirv_spec::DECORATION_BINDING:
+            case spirv_spec::DECORATION_DESCRIPTOR_SET:
+            case spirv_spec::DECORATION_BUILT_IN:
+                return operands.size() >= 3;
+            default:
+                return true;
+            }
+        case spirv_spec::OP_MEMBER_DECORATE:
+            // A struct can't have more members than the module has words.
+            if (operands.size() < 3 || !module.is_id(operands[0]) || operands[1] >= module.words.size()) {
+                return false;
+            }
+            switch (operands[2])
+            {
+            case spirv_spec::DECORATION_OFFSET:
+            case spirv_spec::DECORATION_MATRIX_STRIDE:
+                return operands.size() >= 4;
+            default:
+                return true;
+            }
+        case spirv_spec::OP_TYPE_BOOL:
+        case spirv_spec::OP_TYPE_INT:
+        case spirv_spec::OP_TYPE_FLOAT:
+        case spirv_spec::OP_TYPE_VECTOR:
+        case spirv_spec::OP_TYPE_MATRIX:
+        case spirv_spec::OP_TYPE_IMAGE:
+        case spirv_spec::OP_TYPE_SAMPLER:
+        case spirv_spec::OP_TYPE_SAMPLED_IMAGE:
+        case spirv_spec::OP_TYPE_ARRAY:
+        case spirv_spec::OP_TYPE_RUNTIME_ARRAY:
+        case spirv_spec::OP_TYPE_STRUCT:
+        case spirv_spec::OP_TYPE_POINTER:
+        case spirv_spec::OP_TYPE_ACCELERATION_STRUCTURE_KHR:
+            return operands.size() >= 1 && module.is_id(operands[0]);
+        case spirv_spec::OP_CONSTANT:
+        case spirv_spec::OP_CONSTANT_COMPOSITE:
+        case spirv_spec::OP_SPEC_CONSTANT:
+        case spirv_spec::OP_SPEC_CONSTANT_COMPOSITE:
+        case spirv_spec::OP_VARIABLE:
+            return operands.size() >= 2 && module.is_id(operands[1]);
+        default:
+            return true;
+        }
+    }
+
+    VkShaderStageFlags execution_model_to_stage(uint32_t execution_model)
+    {
+        switch (execution_model)
+        {
+        case 0:    return VK_SHADER_STAGE_VERTEX_BIT;
+        case 1:    return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+        case 2:    return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+        case 3:    return VK_SHADER_STAGE_GEOMETRY_BIT;
+        case 4:    return VK_SHADER_STAGE_FRAGMENT_BIT;
+        case 5:    return VK_SHADER_STAGE_COMPUTE_BIT;
+        case 5267: return VK_SHADER_STAGE_TASK_BIT_NV;
+        case 5268: return VK_SHADER_STAGE_MESH_BIT_NV;
+        case 5313: return VK_SHADER_STAGE_RAYGEN_BIT_KHR;
+        case 5314: return VK_SHADER_STAGE_INTERSECTION_BIT_KHR;
+        case 5315: return VK_SHADER_STAGE_ANY_HIT_BIT_KHR;
+        case 5316: return VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR;
+        case 5317: return VK_SHADER_STAGE_MISS_BIT_KHR;
+        case 5318: return VK_SHADER_STAGE_CALLABLE_BIT_KHR;
+        case 5364: return VK_SHADER_STAGE_TASK_BIT_NV;
+        case 5365: return VK_SHADER_STAGE_MESH_BIT_NV;
+        default:   return 0;
+        }
+    }
+
+    uint32_t get_constant_value(const Spirv_module& module, uint32_t id)
+    {
+        auto op = module.opcode(id);
+        if (op == spirv_spec::OP_CONSTANT || op == spirv_spec::OP_SPEC_CONSTANT) {
+            return module.operand(id, 2);
+        }
+        // Constant expressions such as OpSpecConstantOp can't be evaluated.
+        module.has_error = true;
+        return 0;
+    }
+
+    uint32_t get_type_size(const Spirv_module& module, uint32_t type, const Spirv_member& member)
+    {
+        switch (module.opcode(type))
+        {
+        case spirv_spec::OP_TYPE_BOOL:
+            return 4;
+        case spirv_spec::OP_TYPE_INT:
+        case spirv_spec::OP_TYPE_FLOAT:
+            return module.operand(type, 1) / 8;
+        case spirv_spec::OP_TYPE_VECTOR:
+            return module.operand(type, 2) * get_type_size(module, module.operand_id(type, 1), {});
+        case spirv_spec::OP_TYPE_MATRIX:
+        {
+            uint32_t column_type = module.operand_id(type, 1);
+            uint32_t columns = module.operand(type, 2);
+            if (member.matrix_stride == 0) {
+                return columns * get_type_size(module, column_type, {});
+            }
+            uint32_t rows = module.operand(column_type, 2);
+            return (member.row_major ? rows : columns) * member.matrix_stride;
+        }
+        case spirv_spec::OP_TYPE_ARRAY:
+        {
+            uint32_t length = get_constant_value(module, module.operand_id(type, 2));
+            uint32_t stride = module.ids[type].array_stride;
+            if (stride == 0) {
+                stride = get_type_size(module, module.operand_id(type, 1), member);
+            }
+            return length * stride;
+        }
+        case spirv_spec::OP_TYPE_RUNTIME_ARRAY:
+            return 0;
+        case spirv_spec::OP_TYPE_STRUCT:
+        {
+            const auto& members = module.ids[type].members;
+            uint32_t size = 0;
+            for (uint32_t i = 0; i + 2 < module.word_count(type); i++) {
+                Spirv_member decoration = i < members.size() ? members[i] : Spirv_member();
+                size = std::max(size, decoration.offset + get_type_size(module, module.operand_id(type, 1 + i), decoration));
+            }
+            return size;
+        }
+        default:
+            // Undefined ids end up here as well, their opcode is 0.
+            module.has_error = true;
+            return 0;
+        }
+    }
+
+    /**
+     * @return The descriptor type of the type after stripping all arrays, `nullopt` if it isn't a descriptor.
+    */
+    std::optional<VkDescriptorType> get_descriptor_type(const Spirv_module& module, uint32_t storage_class,
+        uint32_t type)
+    {
+        switch (storage_class)
+        {
+        case spirv_spec::STORAGE_CLASS_UNIFORM:
+            return module.ids[type].is_buffer_block ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        case spirv_spec::STORAGE_CLASS_STORAGE_BUFFER:
+            return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        case spirv_spec::STORAGE_CLASS_UNIFORM_CONSTANT:
+            break;
+        default:
+            return std::nullopt;
+        }
+
+        switch (module.opcode(type))
+        {
+        case spirv_spec::OP_TYPE_SAMPLER:
+            return VK_DESCRIPTOR_TYPE_SAMPLER;
+        case spirv_spec::OP_TYPE_SAMPLED_IMAGE:
+        {
+            uint32_t image = module.operand_id(type, 1);
+            if (module.operand(image, 2) == spirv_spec::DIM_BUFFER) {
+                return VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+            }
+            return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        }
+        case spirv_spec::OP_TYPE_IMAGE:
+        {
+            uint32_t dim = module.operand(type, 2);
+            bool sampled = module.operand(type, 6) == 1;
+            if (dim == spirv_spec::DIM_SUBPASS_DATA) {
+                return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+            }
+            if (dim == spirv_spec::DIM_BUFFER) {
+                return sampled ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+            }
+            return sampled ? VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        }
+        case spirv_spec::OP_TYPE_ACCELERATION_STRUCTURE_KHR:
+            return VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+        default:
+            return std::nullopt;
+        }
+    }
+
+    void sort_bindings(Shader_reflection& reflection)
+    {
+        for (auto& set : reflection.sets) {
+            std::sort(set.begin(), set.end(), [](const auto& a, const auto& b) { return a.binding < b.binding; });
+        }
+    }
+
+    // Vulkan devices bind far fewer sets, larger set numbers are treated as an error instead of allocated.
+    constexpr static uint32_t MAX_REFLECTED_DESCRIPTOR_SETS = 32;
+
+    std::optional<Shader_reflection> reflect_spirv(std::span<const uint32_t> spirv)
+    {
+        Shader_reflection result = {
+            .stages = 0,
+            .sets = {},
+            .push_constant_range = std::nullopt,
+            .workgroup_size = { 0, 0, 0 }
+        };
+        if (spirv.size() < spirv_spec::HEADER_WORD_COUNT || spirv[0] != spirv_spec::MAGIC_NUMBER ||
+            spirv[3] == 0 || spirv[3] > spirv_spec::MAX_ID_BOUND) {
+            return std::nullopt;
+        }
+
+        Spirv_module module = {
+            .words = spirv,
+            .ids = std::vector<Spirv_id>(spirv[3])
+        };
+        std::vector<uint32_t> variables = {};
+        std::vector<uint32_t> execution_modes = {};
+
+        // Decorations precede the declarations they refer to, so everything is gathered first.
+        uint32_t offset = spirv_spec::HEADER_WORD_COUNT;
+        while (offset < spirv.size()) {
+            uint32_t word_count = spirv[offset] >> 16;
+            uint32_t op = spirv[offset] & 0xffff;
+            if (word_count == 0 || offset + word_count > spirv.size()) {
+                return std::nullopt;
+            }
+            auto operands = spirv.subspan(offset + 1, word_count - 1);
+            if (!is_gathered_instruction_valid(module, op, operands)) {
+                return std::nullopt;
+            }
+
+            switch (op)
+            {
+            case spirv_spec::OP_ENTRY_POINT:
+                result.stages |= execution_model_to_stage(operands[0]);
+                break;
+            case spirv_spec::OP_EXECUTION_MODE:
+            case spirv_spec::OP_EXECUTION_MODE_ID:
+                execution_modes.push_back(offset);
+                break;
+            case spirv_spec::OP_DECORATE:
+            {
+                auto& id = module.ids[operands[0]];
+                switch (operands[1])
+                {
+                case spirv_spec::DECORATION_BUFFER_BLOCK: id.is_buffer_block = true; break;
+                case spirv_spec::DECORATION_ARRAY_STRIDE: id.array_stride = operands[2]; break;
+                case spirv_spec::DECORATION_BINDING: id.binding = operands[2]; id.has_binding = true; break;
+                case spirv_spec::DECORATION_DESCRIPTOR_SET: id.descriptor_set = operands[2]; id.has_descriptor_set = true; break;
+                case spirv_spec::DECORATION_BUILT_IN:
+                    id.is_workgroup_size = operands[2] == spirv_spec::BUILT_IN_WORKGROUP_SIZE;
+                    break;
+                default: break;
+                }
+                break;
+            }
+            case spirv_spec::OP_MEMBER_DECORATE:
+            {
+                auto& members = module.ids[operands[0]].members;
+                if (members.size() <= operands[1]) {
+                    members.resize(operands[1] + 1ull);
+                }
+                auto& member = members[operands[1]];
+                switch (operands[2])
+                {
+                case spirv_spec::DECORATION_OFFSET: member.offset = operands[3]; break;
+                case spirv_spec::DECORATION_MATRIX_STRIDE: member.matrix_stride = operands[3]; break;
+                case spirv_spec::DECORATION_ROW_MAJOR: member.row_major = true; break;
+                default: break;
+                }
+                break;
+            }
+            case spirv_spec::OP_TYPE_BOOL:
+            case spirv_spec::OP_TYPE_INT:
+            case spirv_spec::OP_TYPE_FLOAT:
+            case spirv_spec::OP_TYPE_VECTOR:
+            case spirv_spec::OP_TYPE_MATRIX:
+            case spirv_spec::OP_TYPE_IMAGE:
+            case spirv_spec::OP_TYPE_SAMPLER:
+            case spirv_spec::OP_TYPE_SAMPLED_IMAGE:
+            case spirv_spec::OP_TYPE_ARRAY:
+            case spirv_spec::OP_TYPE_RUNTIME_ARRAY:
+            case spirv_spec::OP_TYPE_STRUCT:
+            case spirv_spec::OP_TYPE_POINTER:
+            case spirv_spec::OP_TYPE_ACCELERATION_STRUCTURE_KHR:
+                module.ids[operands[0]].instruction = offset;
+                break;
+            case spirv_spec::OP_CONSTANT:
+            case spirv_spec::OP_CONSTANT_COMPOSITE:
+            case spirv_spec::OP_SPEC_CONSTANT:
+            case spirv_spec::OP_SPEC_CONSTANT_COMPOSITE:
+                module.ids[operands[1]].instruction = offset;
+                break;
+            case spirv_spec::OP_VARIABLE:
+                module.ids[operands[1]].instruction = offset;
+                variables.push_back(operands[1]);
+                break;
+            default:
+                break;
+            }
+            offset += word_count;
+        }
+
+        for (auto variable : variables) {
+            uint32_t pointer_type = module.operand_id(variable, 0);
+            uint32_t storage_class = module.operand(variable, 2);
+            uint32_t type = module.operand_id(pointer_type, 2);
+
+            if (storage_class == spirv_spec::STORAGE_CLASS_PUSH_CONSTANT) {
+                const auto& members = module.ids[type].members;
+                uint32_t begin = UINT32_MAX;
+                for (const auto& member : members) {
+                    begin = std::min(begin, member.offset);
+                }
+                uint32_t end = get_type_size(module, type, {});
+                if (members.empty() || end <= begin) {
+                    continue;
+                }
+                result.push_constant_range = Pipeline_layout_push_constant_range{
+                    .size = end - begin,
+                    .offset = begin,
+                    .stages = result.stages
+                };
+                continue;
+            }
+
+            const auto& decorations = module.ids[variable];
+            if (!decorations.has_binding || !decorations.has_descriptor_set) {
+                continue;
+            }
+            uint32_t count = 1;
+            while (module.opcode(type) == spirv_spec::OP_TYPE_ARRAY ||
+                module.opcode(type) == spirv_spec::OP_TYPE_RUNTIME_ARRAY) {
+                if (module.opcode(type) == spirv_spec::OP_TYPE_ARRAY) {
+                    count *= get_constant_value(module, module.operand_id(type, 2));
+                }
+                else {
+                    count = 0;
+                }
+                type = module.operand_id(type, 1);
+            }
+            auto descriptor_type = get_descriptor_type(module, storage_class, type);
+            if (!descriptor_type.has_value()) {
+                continue;
+            }
+
+            if (decorations.descriptor_set >= MAX_REFLECTED_DESCRIPTOR_SETS) {
+                return std::nullopt;
+            }
+            if (result.sets.size() <= decorations.descriptor_set) {
+                result.sets.resize(decorations.descriptor_set + 1ull);
+            }
+            result.sets[decorations.descriptor_set].push_back({
+                .binding = decorations.binding,
+                .type = descriptor_type.value(),
+                .count = count,
+                .stages = result.stages,
+                .immutable_samplers = {},
+                .flags = 0
+                });
+        }
+        if (module.has_error) {
+            return std::nullopt;
+        }
+        sort_bindings(result);
+
+        for (auto execution_mode : execution_modes) {
+            const uint32_t* operands = &spirv[execution_mode + 1];
+            bool is_id = (spirv[execution_mode] & 0xffff) == spirv_spec::OP_EXECUTION_MODE_ID;
+            if (!is_id && operands[1] == spirv_spec::EXECUTION_MODE_LOCAL_SIZE) {
+                result.workgroup_size = { operands[2], operands[3], operands[4] };
+            }
+            else if (is_id && operands[1] == spirv_spec::EXECUTION_MODE_LOCAL_SIZE_ID) {
+                for (uint32_t i = 0; i < 3; i++) {
+                    result.workgroup_size[i] = get_constant_value(module, operands[2 + i]);
+                }
+            }
+        }
+        // A constant decorated with the WorkgroupSize builtin overrides the execution mode.
+        for (uint32_t id = 0; id < module.ids.size(); id++) {
+            if (module.ids[id].is_workgroup_size && module.ids[id].instruction != 0) {
+                auto op = module.opcode(id);
+                if (op != spirv_spec::OP_CONSTANT_COMPOSITE && op != spirv_spec::OP_SPEC_CONSTANT_COMPOSITE) {
+                    return std::nullopt;
+                }
+                for (uint32_t i = 0; i < 3; i++) {
+                    result.workgroup_size[i] = get_constant_value(module, module.operand_id(id, 2 + i));
+                }
+            }
+        }
+        if (module.has_error) {
+            return std::nullopt;
+        }
+        return result;
+    }
+
+    void merge_shader_reflection(Shader_reflection& dst, const Shader_reflection& src)
+    {
+        dst.stages |= src.stages;
+
+        if (dst.sets.size() < src.sets.size()) {
+            dst.sets.resize(src.sets.size());
+        }
+        for (std::size_t set = 0; set < src.sets.size(); set++) {
+            auto& dst_bindings = dst.sets[set];
+            for (const auto& src_binding : src.sets[set]) {
+                auto it = std::find_if(dst_bindings.begin(), dst_bindings.end(),
+                    [&src_binding](const auto& b) { return b.binding == src_binding.binding; });
+                if (it == dst_bindings.end()) {
+                    dst_bindings.push_back(src_binding);
+                    continue;
+                }
+                assert(it->type == src_binding.type && "Shader stages disagree on the type of a binding.");
+                it->stages |= src_binding.stages;
+                // Zero marks a runtime array, which stays unbounded.
+                it->count = (it->count == 0 || src_binding.count == 0) ? 0 : std::max(it->count, src_binding.count);
+            }
+        }
+        sort_bindings(dst);
+
+        if (src.push_constant_range.has_value()) {
+            if (dst.push_constant_range.has_value()) {
+                auto& dst_range = dst.push_constant_range.value();
+                const auto& src_range = src.push_constant_range.value();
+                uint32_t begin = std::min(dst_range.offset, src_range.offset);
+                uint32_t end = std::max(dst_range.offset + dst_range.size, src_range.offset + src_range.size);
+                dst_range = {
+                    .size = end - begin,
+                    .offset = begin,
+                    .stages = dst_range.stages | src_range.stages
+                };
+            }
+            else {
+                dst.push_constant_range = src.push_constant_range;
+            }
+        }
+
+        if (dst.workgroup_size[0] == 0) {
+            dst.workgroup_size = src.workgroup_size;
+        }
+    }
+}
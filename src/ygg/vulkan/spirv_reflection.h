@@ -0,0 +1,57 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include "ygg/vulkan/descriptors.h"
+#include "ygg/vulkan/vk_forward_decl.h"
+
+#include <array>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace ygg::vk
+{
+    /**
+     * @brief Resource interface of one or more shader stages, reflected from Spirv.
+    */
+    struct Shader_reflection
+    {
+        VkShaderStageFlags stages;
+
+        /**
+         * Bindings of every descriptor set, indexed by set number. Sets without any bindings are empty.
+         * Runtime arrays have a count of zero, their size has to be chosen before creating a layout,
+         * creating a pipeline layout directly from such a reflection aborts.
+         * Dynamic buffer descriptors can't be reflected, buffers are always reflected as non-dynamic.
+        */
+        std::vector<std::vector<Descriptor_set_layout_binding>> sets;
+
+        /**
+         * The range of the push constant block, from its first to the end of its last used member.
+        */
+        std::optional<Pipeline_layout_push_constant_range> push_constant_range;
+
+        /**
+         * Local workgroup size of compute shaders, zero for all other stages.
+        */
+        std::array<uint32_t, 3> workgroup_size;
+    };
+
+    /**
+     * @brief Reflects the descriptor bindings, push constants and workgroup size of a Spirv module.
+     * @details All resources declared by the module are reflected, whether or not an entry point uses them.
+     * If the module contains multiple entry points, every binding is used by all of their stages.
+     * @return The reflection, `nullopt` if the module is malformed, refers to ids outside of its bound
+     * or uses constructs that can't be reflected, such as sizes given by specialization constant expressions.
+    */
+    std::optional<Shader_reflection> reflect_spirv(std::span<const uint32_t> spirv);
+
+    /**
+     * @brief Merges the reflection of other stages into `dst`.
+     * @details Bindings used by multiple stages are merged into a single binding visible to all of them,
+     * push constant ranges are merged into a single range. Bindings with the same set and binding number
+     * but different descriptor types are invalid.
+    */
+    void merge_shader_reflection(Shader_reflection& dst, const Shader_reflection& src);
+}
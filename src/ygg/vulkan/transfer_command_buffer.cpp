@@ -6,8 +6,12 @@
 #include "ygg/vulkan/image_utils.h"
 #include "ygg/vulkan/linear_host_resource_allocator.h"
 #include "ygg/vulkan/resource.h"
+#include "ygg/vulkan/upload_batch.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <numeric>
 #include <volk.h>
 
 namespace ygg::vk
@@ -34,13 +38,13 @@ namespace ygg::vk
         vkEndCommandBuffer(m_cmdbuf);
     }
 
-    void cmd_upload_buffer(VkCommandBuffer cmdbuf, Linear_host_resource_allocator::Mapped_host_buffer& src,
+    void cmd_upload_buffer(VkCommandBuffer cmdbuf, const Linear_host_resource_allocator::Mapped_host_buffer& src,
         Buffer& dst, VkDeviceSize size, VkDeviceSize offset, uint32_t frame_in_flight)
     {
         VkBufferCopy2 copy_region = {
             .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2,
             .pNext = nullptr,
-            .srcOffset = 0ull,
+            .srcOffset = src.offset,
             .dstOffset = offset,
             .size = size
         };
@@ -55,14 +59,14 @@ namespace ygg::vk
         vkCmdCopyBuffer2(cmdbuf, &copy_info);
     }
 
-    void cmd_upload_color_image(VkCommandBuffer cmdbuf, Linear_host_resource_allocator::Mapped_host_buffer& src,
+    void cmd_upload_color_image(VkCommandBuffer cmdbuf, const Linear_host_resource_allocator::Mapped_host_buffer& src,
         Image& dst, uint32_t width, uint32_t height, uint32_t depth, int32_t width_offset, int32_t height_offset,
         int32_t depth_offset, uint32_t layers, uint32_t base_layer, uint32_t mip_level)
     {
         VkBufferImageCopy2 copy_region = {
             .sType = VK_STRUCTURE_TYPE_BUFFER_IMAGE_COPY_2,
             .pNext = nullptr,
-            .bufferOffset = 0,
+            .bufferOffset = src.offset,
             .bufferRowLength = 0,
             .bufferImageHeight = 0,
             .imageSubresource = {
@@ -86,12 +90,20 @@ namespace ygg::vk
         vkCmdCopyBufferToImage2(cmdbuf, &copy_info);
     }
 
+    VkDeviceSize image_staging_alignment(VkFormat format)
+    {
+        // Buffer offsets of buffer-image copies must be a multiple of the texel block size
+        // and a multiple of 4 on transfer-only queues.
+        VkDeviceSize texel_size = std::max(VkDeviceSize(img_utils::format_size(format)), VkDeviceSize(1));
+        return std::lcm(Linear_host_resource_allocator::DEFAULT_ALIGNMENT, texel_size);
+    }
+
     void Transfer_command_buffer::upload_buffer_data(Buffer& buffer, void* data, VkDeviceSize size, VkDeviceSize offset)
     {
         switch (buffer.info.domain)
         {
         default: {
-            auto& allocation = m_allocator.allocate_buffer(size, m_queue_family_index);
+            auto allocation = m_allocator.allocate_buffer(size);
             memcpy(allocation.mapped_data, data, size);
             cmd_upload_buffer(m_cmdbuf, allocation, buffer, size, offset, m_frame_in_flight);
             break;
@@ -106,24 +118,117 @@ namespace ygg::vk
         }
     }
 
+    void Transfer_command_buffer::flush_upload_batch(Buffer_upload_batch& batch)
+    {
+        batch.flush(m_cmdbuf, m_allocator, m_frame_in_flight);
+    }
+
     void Transfer_command_buffer::upload_image_data(Image& image, void* data, uint32_t width, uint32_t height,
         uint32_t depth, uint32_t width_offset, uint32_t height_offset, uint32_t depth_offset, uint32_t layers,
         uint32_t base_layer, uint32_t mip_level)
     {
-        VkDeviceSize size = width * height * depth * img_utils::format_size(image.info.format);
-        auto& allocated_buffer = m_allocator.allocate_buffer(size, m_queue_family_index);
+        VkDeviceSize size = img_utils::get_region_size(image.info.format, width, height, depth) * layers;
+        auto allocated_buffer = m_allocator.allocate_buffer(size, image_staging_alignment(image.info.format));
         memcpy(allocated_buffer.mapped_data, data, size);
         cmd_upload_color_image(m_cmdbuf, allocated_buffer, image, width, height, depth,
             width_offset, height_offset, depth_offset, layers, base_layer, mip_level);
     }
 
+    void Transfer_command_buffer::upload_image_mip_chain(Image& image, const void* data, uint32_t base_mip_level,
+        uint32_t mip_levels, uint32_t base_layer, uint32_t layers, VkImageLayout old_layout, VkImageLayout new_layout)
+    {
+        if (mip_levels == 0 || mip_levels > MAX_UPLOAD_MIP_LEVELS) {
+            assert(false && "Mip level count must be between 1 and MAX_UPLOAD_MIP_LEVELS.");
+            return;
+        }
+        VkImageAspectFlags aspect = img_utils::get_default_aspect_mask(image.info.format);
+        if (aspect == (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)) {
+            assert(false && "Uploading to combined depth-stencil images is not supported.");
+            return;
+        }
+
+        // Every region starts at an aligned offset, so the staging size includes the padding between mip levels.
+        VkDeviceSize alignment = image_staging_alignment(image.info.format);
+        std::array<VkDeviceSize, MAX_UPLOAD_MIP_LEVELS> region_offsets = {};
+        VkDeviceSize staging_size = 0;
+        for (uint32_t i = 0; i < mip_levels; i++) {
+            region_offsets[i] = (staging_size + alignment - 1) / alignment * alignment;
+            staging_size = region_offsets[i] + img_utils::get_mip_level_size(image.info, base_mip_level + i) * layers;
+        }
+        auto staging = m_allocator.allocate_buffer(staging_size, alignment);
+
+        uint32_t block_extent = img_utils::format_block_extent(image.info.format);
+        std::array<VkBufferImageCopy2, MAX_UPLOAD_MIP_LEVELS> regions = {};
+        const uint8_t* src = static_cast<const uint8_t*>(data);
+        for (uint32_t i = 0; i < mip_levels; i++) {
+            uint32_t mip_level = base_mip_level + i;
+            VkDeviceSize size = img_utils::get_mip_level_size(image.info, mip_level) * layers;
+            memcpy(&static_cast<uint8_t*>(staging.mapped_data)[region_offsets[i]], src, size);
+            src += size;
+
+            uint32_t width = img_utils::get_mip_extent(image.info.width, mip_level);
+            uint32_t height = img_utils::get_mip_extent(image.info.height, mip_level);
+            regions[i] = {
+                .sType = VK_STRUCTURE_TYPE_BUFFER_IMAGE_COPY_2,
+                .pNext = nullptr,
+                .bufferOffset = staging.offset + region_offsets[i],
+                .bufferRowLength = (width + block_extent - 1) / block_extent * block_extent,
+                .bufferImageHeight = (height + block_extent - 1) / block_extent * block_extent,
+                .imageSubresource = {
+                    .aspectMask = aspect,
+                    .mipLevel = mip_level,
+                    .baseArrayLayer = base_layer,
+                    .layerCount = layers,
+                },
+                .imageOffset = { 0, 0, 0 },
+                .imageExtent = { width, height, img_utils::get_mip_extent(image.info.depth, mip_level) }
+            };
+        }
+
+        VkImageSubresourceRange subresource_range = {
+            .aspectMask = aspect,
+            .baseMipLevel = base_mip_level,
+            .levelCount = mip_levels,
+            .baseArrayLayer = base_layer,
+            .layerCount = layers
+        };
+        bool discard = old_layout == VK_IMAGE_LAYOUT_UNDEFINED;
+        m_pipeline_barrier_builder
+            .push_image_memory_barrier(
+                discard ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                discard ? VK_ACCESS_2_NONE : VK_ACCESS_2_MEMORY_WRITE_BIT,
+                VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                old_layout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                image.allocated_image.handle, subresource_range)
+            .flush(0);
+
+        VkCopyBufferToImageInfo2 copy_info = {
+            .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_TO_IMAGE_INFO_2,
+            .pNext = nullptr,
+            .srcBuffer = staging.buf,
+            .dstImage = image.allocated_image.handle,
+            .dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .regionCount = mip_levels,
+            .pRegions = regions.data()
+        };
+        vkCmdCopyBufferToImage2(m_cmdbuf, &copy_info);
+
+        m_pipeline_barrier_builder
+            .push_image_memory_barrier(
+                VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, new_layout,
+                image.allocated_image.handle, subresource_range)
+            .flush(0);
+    }
+
     void* Transfer_command_buffer::allocate_and_upload_buffer_data(Buffer& buffer, VkDeviceSize size, VkDeviceSize offset)
     {
         if (buffer.info.domain != Buffer_domain::Device) {
             assert(false && "The used Buffer_domain in the passed buffer must be Buffer_domain::Device to use this function.");
             return nullptr;
         }
-        auto& allocation = m_allocator.allocate_buffer(size, m_queue_family_index);
+        auto allocation = m_allocator.allocate_buffer(size);
         cmd_upload_buffer(m_cmdbuf, allocation, buffer, size, offset, m_frame_in_flight);
         return allocation.mapped_data;
     }
@@ -132,8 +237,9 @@ namespace ygg::vk
         uint32_t height, uint32_t depth, uint32_t width_offset, uint32_t height_offset,
         uint32_t depth_offset, uint32_t layers, uint32_t base_layer, uint32_t mip_level)
     {
-        auto& allocated_buffer = m_allocator
-            .allocate_buffer(width * height * depth * img_utils::format_size(image.info.format), m_queue_family_index);
+        auto allocated_buffer = m_allocator.allocate_buffer(
+            img_utils::get_region_size(image.info.format, width, height, depth) * layers,
+            image_staging_alignment(image.info.format));
         cmd_upload_color_image(m_cmdbuf, allocated_buffer, image, width, height, depth,
             width_offset, height_offset, depth_offset, layers, base_layer, mip_level);
         return allocated_buffer.mapped_data;
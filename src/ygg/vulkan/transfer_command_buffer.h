@@ -7,6 +7,7 @@
 
 namespace ygg::vk
 {
+    class Buffer_upload_batch;
     class Command_buffer_recycler;
     class Linear_host_resource_allocator;
     struct Buffer;
@@ -58,6 +59,9 @@ namespace ygg::vk
     */
     class Transfer_command_buffer
     {
+    public:
+        constexpr static uint32_t MAX_UPLOAD_MIP_LEVELS = 16;
+
     public:
         /**
          * @brief Creates and binds the wrapper instance to the given `VkCommandBuffer`.
@@ -95,6 +99,12 @@ namespace ygg::vk
         */
         void upload_buffer_data(Buffer& buffer, void* data, VkDeviceSize size, VkDeviceSize offset);
 
+        /**
+         * @brief Records all uploads stored in the batch using a single staging allocation and clears it.
+         * @details Prefer this over multiple calls to `upload_buffer_data` when uploading many small ranges.
+        */
+        void flush_upload_batch(Buffer_upload_batch& batch);
+
         /**
          * @brief Uploads provided data to an image.
          * @details The caller is responsible for transitioning the image into `VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL`
@@ -105,6 +115,18 @@ namespace ygg::vk
             uint32_t width_offset, uint32_t height_offset, uint32_t depth_offset, uint32_t layers,
             uint32_t base_layer, uint32_t mip_level);
 
+        /**
+         * @brief Uploads whole mip levels and array layers of an image with a single copy command.
+         * @details `data` contains the tightly packed mip levels in ascending order, each holding all array layers.
+         * Block-compressed formats are packed in whole blocks. The sizes can be queried using `img_utils::get_mip_chain_size`.
+         * The image is transitioned from `old_layout` into `VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL` before
+         * and into `new_layout` after the copy, only the uploaded subresources are affected.
+         * Uploading data to a combined depth-stencil image or more than `MAX_UPLOAD_MIP_LEVELS` mip levels
+         * is not supported with this command, nothing is recorded in that case.
+        */
+        void upload_image_mip_chain(Image& image, const void* data, uint32_t base_mip_level, uint32_t mip_levels,
+            uint32_t base_layer, uint32_t layers, VkImageLayout old_layout, VkImageLayout new_layout);
+
         /**
          * @brief Allocates a staging region and copies the contents from the region to the buffer.
          * @details This command is a *NOOP* for buffers that are not residing in the `Device` domain.
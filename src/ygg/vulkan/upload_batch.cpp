@@ -0,0 +1,175 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/vulkan/upload_batch.h"
+
+#include "ygg/vulkan/linear_host_resource_allocator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <volk.h>
+
+namespace ygg::vk
+{
+    struct Buffer_upload_batch::Upload_store
+    {
+        struct Pending_upload
+        {
+            Buffer buffer;
+            VkDeviceSize data_offset;
+            VkDeviceSize dst_offset;
+            VkDeviceSize size;
+            uint32_t range_index;
+        };
+
+        struct Merged_range
+        {
+            VkBuffer dst;
+            VkDeviceSize dst_offset;
+            VkDeviceSize size;
+            VkDeviceSize staging_offset;
+        };
+
+        std::vector<Pending_upload> uploads;
+        std::vector<uint8_t> data;
+        std::vector<uint32_t> order;
+        std::vector<Merged_range> ranges;
+        std::vector<VkBufferCopy2> regions;
+    };
+
+    Buffer_upload_batch::Buffer_upload_batch()
+        : m_store(std::make_unique<Upload_store>())
+    {}
+
+    Buffer_upload_batch::~Buffer_upload_batch()
+    {}
+
+    Buffer_upload_batch& Buffer_upload_batch::push_buffer_upload(const Buffer& buffer, const void* data,
+        VkDeviceSize size, VkDeviceSize offset)
+    {
+        if (size == 0) {
+            return *this;
+        }
+        VkDeviceSize data_offset = m_store->data.size();
+        m_store->data.resize(data_offset + size);
+        memcpy(&m_store->data[data_offset], data, size);
+        m_store->uploads.push_back({
+            .buffer = buffer,
+            .data_offset = data_offset,
+            .dst_offset = offset,
+            .size = size,
+            .range_index = 0
+            });
+        return *this;
+    }
+
+    void Buffer_upload_batch::flush(VkCommandBuffer cmdbuf, Linear_host_resource_allocator& allocator,
+        uint32_t frame_in_flight)
+    {
+        auto& store = *m_store;
+        auto& uploads = store.uploads;
+        auto& order = store.order;
+        auto& ranges = store.ranges;
+
+        order.clear();
+        for (uint32_t i = 0; i < uploads.size(); i++) {
+            const auto& upload = uploads[i];
+            if (upload.buffer.info.domain == Buffer_domain::Device) {
+                order.push_back(i);
+            }
+            else {
+                auto& allocated_buffer = select_allocated_buffer(upload.buffer, frame_in_flight);
+                memcpy(&static_cast<uint8_t*>(allocated_buffer.mapped_data)[upload.dst_offset],
+                    &store.data[upload.data_offset], upload.size);
+            }
+        }
+        if (order.empty()) {
+            clear();
+            return;
+        }
+
+        // Device domain buffers only have a single allocated buffer, so the handle identifies the destination.
+        std::sort(order.begin(), order.end(), [&uploads](uint32_t a, uint32_t b) {
+            VkBuffer dst_a = uploads[a].buffer.allocated_buffers[0].handle;
+            VkBuffer dst_b = uploads[b].buffer.allocated_buffers[0].handle;
+            if (dst_a != dst_b) {
+                return dst_a < dst_b;
+            }
+            return uploads[a].dst_offset < uploads[b].dst_offset;
+        });
+
+        ranges.clear();
+        VkDeviceSize staging_size = 0;
+        for (auto i : order) {
+            auto& upload = uploads[i];
+            VkBuffer dst = upload.buffer.allocated_buffers[0].handle;
+            if (!ranges.empty() && ranges.back().dst == dst &&
+                upload.dst_offset <= ranges.back().dst_offset + ranges.back().size) {
+                auto& range = ranges.back();
+                VkDeviceSize end = std::max(range.dst_offset + range.size, upload.dst_offset + upload.size);
+                staging_size += end - (range.dst_offset + range.size);
+                range.size = end - range.dst_offset;
+            }
+            else {
+                ranges.push_back({
+                    .dst = dst,
+                    .dst_offset = upload.dst_offset,
+                    .size = upload.size,
+                    .staging_offset = staging_size
+                    });
+                staging_size += upload.size;
+            }
+            upload.range_index = uint32_t(ranges.size() - 1);
+        }
+
+        auto staging = allocator.allocate_buffer(staging_size);
+        auto staging_data = static_cast<uint8_t*>(staging.mapped_data);
+        // Copy in push order so later uploads overwrite earlier overlapping ones.
+        for (const auto& upload : uploads) {
+            if (upload.buffer.info.domain != Buffer_domain::Device) {
+                continue;
+            }
+            const auto& range = ranges[upload.range_index];
+            memcpy(&staging_data[range.staging_offset + upload.dst_offset - range.dst_offset],
+                &store.data[upload.data_offset], upload.size);
+        }
+
+        std::size_t first = 0;
+        while (first < ranges.size()) {
+            std::size_t last = first;
+            store.regions.clear();
+            while (last < ranges.size() && ranges[last].dst == ranges[first].dst) {
+                store.regions.push_back({
+                    .sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2,
+                    .pNext = nullptr,
+                    .srcOffset = staging.offset + ranges[last].staging_offset,
+                    .dstOffset = ranges[last].dst_offset,
+                    .size = ranges[last].size
+                    });
+                last++;
+            }
+            VkCopyBufferInfo2 copy_info = {
+                .sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2,
+                .pNext = nullptr,
+                .srcBuffer = staging.buf,
+                .dstBuffer = ranges[first].dst,
+                .regionCount = uint32_t(store.regions.size()),
+                .pRegions = store.regions.data()
+            };
+            vkCmdCopyBuffer2(cmdbuf, &copy_info);
+            first = last;
+        }
+        clear();
+    }
+
+    void Buffer_upload_batch::clear()
+    {
+        m_store->uploads.clear();
+        m_store->data.clear();
+    }
+
+    bool Buffer_upload_batch::empty() const
+    {
+        return m_store->uploads.empty();
+    }
+}
@@ -0,0 +1,65 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include "ygg/vulkan/resource.h"
+#include "ygg/vulkan/vk_forward_decl.h"
+
+#include <memory>
+
+namespace ygg::vk
+{
+    class Linear_host_resource_allocator;
+
+    /**
+     * @brief Collects buffer uploads and records them with as few copy commands as possible.
+     * @details The uploaded data is copied into the batch when pushing, so the source memory can be
+     * reused immediately. On flush, the ranges of every destination buffer are sorted and adjacent
+     * or overlapping ranges are merged. All merged ranges are packed into a single staging allocation
+     * and each destination buffer receives a single `vkCmdCopyBuffer2` containing all of its regions.
+     * Overlapping uploads resolve in push order, the last push wins.
+     * Buffers that are not in the `Device` domain are written directly on flush.
+     * The internal storage is kept between flushes, so reusing a batch does not allocate once warm.
+    */
+    class Buffer_upload_batch
+    {
+    public:
+        Buffer_upload_batch();
+        ~Buffer_upload_batch();
+
+        Buffer_upload_batch(const Buffer_upload_batch& other) = delete;
+        Buffer_upload_batch& operator=(const Buffer_upload_batch& other) = delete;
+
+        /**
+         * @brief Stores an upload of the given data to the buffer, to be recorded on `flush()`.
+         * @details The Buffer is copied, it does not need to outlive this call but its handles must
+         * still be valid on flush.
+         * @return This instance.
+        */
+        Buffer_upload_batch& push_buffer_upload(const Buffer& buffer, const void* data,
+            VkDeviceSize size, VkDeviceSize offset);
+
+        /**
+         * @brief Records all stored uploads into the command buffer and clears this batch.
+         * @details Usually called through `Transfer_command_buffer::flush_upload_batch`.
+         * @param cmdbuf The command buffer to record the copies into.
+         * @param allocator The allocator to use for the staging allocation.
+         * @param frame_in_flight The current frame in flight, used to select host visible buffers.
+        */
+        void flush(VkCommandBuffer cmdbuf, Linear_host_resource_allocator& allocator, uint32_t frame_in_flight);
+
+        /**
+         * @brief Discards all stored uploads.
+        */
+        void clear();
+
+        /**
+         * @brief Returns whether or not any uploads are stored.
+        */
+        bool empty() const;
+
+    private:
+        struct Upload_store;
+        std::unique_ptr<Upload_store> m_store;
+    };
+}
@@ -0,0 +1,231 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/vulkan/upload_service.h"
+
+#include "ygg/vulkan/image_utils.h"
+#include "ygg/vulkan/linear_host_resource_allocator.h"
+
+#include <volk.h>
+#include <vk_mem_alloc.h>
+
+namespace ygg::vk
+{
+    Upload_service::Upload_service(Context& context)
+        : m_context(context), m_pool(create_linear_host_resource_pool(context.allocator())),
+        m_command_buffer_recycler(context.device(), context.transfer_queue().queue_family_index,
+            VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT),
+        m_timeline(context.create_timeline_semaphore(0))
+    {}
+
+    Upload_service::~Upload_service()
+    {
+        if (m_open_cmdbuf.has_value()) {
+            m_open_cmdbuf->end();
+            m_open_cmdbuf.reset();
+        }
+        uint64_t last_value = m_next_value - 1;
+        VkSemaphoreWaitInfo wait_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .semaphoreCount = 1,
+            .pSemaphores = &m_timeline,
+            .pValues = &last_value
+        };
+        vkWaitSemaphores(m_context.device(), &wait_info, ~0ull);
+
+        m_open_allocator.reset();
+        m_pending_batches.clear();
+        m_free_allocators.clear();
+        vmaDestroyPool(m_context.allocator(), m_pool);
+        vkDestroySemaphore(m_context.device(), m_timeline, nullptr);
+    }
+
+    void Upload_service::upload_buffer(const Buffer& buffer, const void* data, VkDeviceSize size,
+        VkDeviceSize offset, uint32_t dst_queue_family_index)
+    {
+        open_batch();
+        m_buffer_upload_batch.push_buffer_upload(buffer, data, size, offset);
+        if (buffer.info.domain == Buffer_domain::Device) {
+            push_buffer_release(buffer, dst_queue_family_index);
+        }
+    }
+
+    void Upload_service::upload_image(Image& image, const void* data, uint32_t base_mip_level, uint32_t mip_levels,
+        uint32_t base_layer, uint32_t layers, VkImageLayout final_layout, uint32_t dst_queue_family_index)
+    {
+        auto& cmdbuf = open_batch();
+        if (dst_queue_family_index == m_context.transfer_queue().queue_family_index) {
+            cmdbuf.upload_image_mip_chain(image, data, base_mip_level, mip_levels, base_layer, layers,
+                VK_IMAGE_LAYOUT_UNDEFINED, final_layout);
+            return;
+        }
+        // The layout transition into the final layout is done by the ownership transfer.
+        cmdbuf.upload_image_mip_chain(image, data, base_mip_level, mip_levels, base_layer, layers,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        m_open_transfers.push_back({
+            .buffer = VK_NULL_HANDLE,
+            .image = image.allocated_image.handle,
+            .old_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .new_layout = final_layout,
+            .dst_queue_family_index = dst_queue_family_index,
+            .aspect = img_utils::get_default_aspect_mask(image.info.format),
+            .base_mip_level = base_mip_level,
+            .mip_levels = mip_levels,
+            .base_layer = base_layer,
+            .layers = layers
+            });
+    }
+
+    uint64_t Upload_service::submit()
+    {
+        if (!m_open_cmdbuf.has_value()) {
+            return 0;
+        }
+        auto& cmdbuf = *m_open_cmdbuf;
+        cmdbuf.flush_upload_batch(m_buffer_upload_batch);
+
+        uint32_t transfer_queue_family_index = m_context.transfer_queue().queue_family_index;
+        auto& barrier_builder = cmdbuf.pipeline_barrier_builder();
+        for (const auto& transfer : m_open_transfers) {
+            if (transfer.buffer) {
+                barrier_builder.push_buffer_memory_barrier(
+                    VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, 0, 0,
+                    transfer_queue_family_index, transfer.dst_queue_family_index,
+                    transfer.buffer, 0, VK_WHOLE_SIZE);
+            }
+            else {
+                barrier_builder.push_image_memory_barrier(
+                    VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, 0, 0,
+                    transfer.old_layout, transfer.new_layout,
+                    transfer_queue_family_index, transfer.dst_queue_family_index, transfer.image,
+                    { transfer.aspect, transfer.base_mip_level, transfer.mip_levels, transfer.base_layer, transfer.layers });
+            }
+        }
+        barrier_builder.flush(0);
+        cmdbuf.end();
+
+        uint64_t value = m_next_value++;
+        VkCommandBuffer handle = cmdbuf.handle();
+        Semaphore_signal_info signal_info = {
+            .semaphore = m_timeline,
+            .value = value,
+            .stage_mask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+        };
+        Submit submit_info = {
+            .await_semas = {},
+            .cmd_bufs = { &handle, 1 },
+            .signal_semas = { &signal_info, 1 }
+        };
+        m_context.submit(m_context.transfer_queue().queue, submit_info, VK_NULL_HANDLE);
+
+        m_pending_batches.push_back({ value, handle, std::move(m_open_allocator) });
+        if (!m_open_transfers.empty()) {
+            m_pending_acquires.push_back({ value, std::move(m_open_transfers) });
+            m_open_transfers.clear();
+        }
+        m_open_cmdbuf.reset();
+        return value;
+    }
+
+    void Upload_service::push_acquire_barriers(Pipeline_barrier_builder& builder, uint64_t value)
+    {
+        uint32_t transfer_queue_family_index = m_context.transfer_queue().queue_family_index;
+        for (auto it = m_pending_acquires.begin(); it != m_pending_acquires.end(); ++it) {
+            if (it->value != value) {
+                continue;
+            }
+            for (const auto& transfer : it->transfers) {
+                if (transfer.buffer) {
+                    builder.push_buffer_qfot_import_memory_barrier(transfer_queue_family_index,
+                        transfer.dst_queue_family_index, transfer.buffer, 0, VK_WHOLE_SIZE,
+                        VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT);
+                }
+                else {
+                    builder.push_image_qfot_import_memory_barrier(transfer.old_layout, transfer.new_layout,
+                        transfer_queue_family_index, transfer.dst_queue_family_index, transfer.image,
+                        { transfer.aspect, transfer.base_mip_level, transfer.mip_levels, transfer.base_layer, transfer.layers },
+                        VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT);
+                }
+            }
+            m_pending_acquires.erase(it);
+            return;
+        }
+    }
+
+    Semaphore_signal_info Upload_service::wait_info(uint64_t value, VkPipelineStageFlags2 stage_mask) const
+    {
+        return { m_timeline, value, stage_mask };
+    }
+
+    bool Upload_service::is_complete(uint64_t value) const
+    {
+        uint64_t completed_value = 0;
+        vkGetSemaphoreCounterValue(m_context.device(), m_timeline, &completed_value);
+        return completed_value >= value;
+    }
+
+    void Upload_service::collect()
+    {
+        uint64_t completed_value = 0;
+        vkGetSemaphoreCounterValue(m_context.device(), m_timeline, &completed_value);
+        std::size_t kept = 0;
+        for (auto& batch : m_pending_batches) {
+            if (batch.value <= completed_value) {
+                m_command_buffer_recycler.make_available_immediate(batch.cmdbuf, false);
+                batch.allocator->reset();
+                m_free_allocators.push_back(std::move(batch.allocator));
+            }
+            else {
+                m_pending_batches[kept++] = std::move(batch);
+            }
+        }
+        m_pending_batches.erase(m_pending_batches.begin() + kept, m_pending_batches.end());
+    }
+
+    Transfer_command_buffer& Upload_service::open_batch()
+    {
+        if (m_open_cmdbuf.has_value()) {
+            return *m_open_cmdbuf;
+        }
+        uint32_t transfer_queue_family_index = m_context.transfer_queue().queue_family_index;
+        if (m_free_allocators.empty()) {
+            m_open_allocator = std::make_unique<Linear_host_resource_allocator>(m_context.allocator(), m_pool,
+                transfer_queue_family_index);
+        }
+        else {
+            m_open_allocator = std::move(m_free_allocators.back());
+            m_free_allocators.pop_back();
+        }
+        m_open_cmdbuf.emplace(m_command_buffer_recycler.get_or_allocate(), *m_open_allocator,
+            m_context.current_frame_in_flight(), transfer_queue_family_index);
+        m_open_cmdbuf->begin();
+        return *m_open_cmdbuf;
+    }
+
+    void Upload_service::push_buffer_release(const Buffer& buffer, uint32_t dst_queue_family_index)
+    {
+        if (dst_queue_family_index == m_context.transfer_queue().queue_family_index) {
+            return;
+        }
+        // Buffers are only uploaded to before their first use, so there is no previous owner to acquire from.
+        VkBuffer handle = buffer.allocated_buffers[0].handle;
+        for (const auto& transfer : m_open_transfers) {
+            if (transfer.buffer == handle) {
+                return;
+            }
+        }
+        m_open_transfers.push_back({
+            .buffer = handle,
+            .image = VK_NULL_HANDLE,
+            .old_layout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .new_layout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .dst_queue_family_index = dst_queue_family_index,
+            .aspect = 0,
+            .base_mip_level = 0,
+            .mip_levels = 0,
+            .base_layer = 0,
+            .layers = 0
+            });
+    }
+}
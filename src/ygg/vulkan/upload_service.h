@@ -0,0 +1,142 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include "ygg/vulkan/command_buffer_recycler.h"
+#include "ygg/vulkan/context.h"
+#include "ygg/vulkan/transfer_command_buffer.h"
+#include "ygg/vulkan/upload_batch.h"
+#include "ygg/vulkan/vk_forward_decl.h"
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace ygg::vk
+{
+    /**
+     * @brief Records uploads on the transfer queue, so they can overlap with rendering.
+     * @details Uploads are recorded into an open batch, which is submitted to the transfer queue on `submit()`.
+     * Every submitted batch signals a timeline semaphore with a unique value. Resources uploaded in a batch are
+     * released to their destination queue family, consumers have to wait for the value of the batch and record
+     * the matching acquire barriers with `push_acquire_barriers()` before using them.
+     * If the transfer queue belongs to the same queue family as the destination, no ownership transfer is done.
+     * Command buffers and staging memory of a batch are recycled once the timeline passes its value.
+     * All functions must be externally synchronized.
+    */
+    class Upload_service
+    {
+    public:
+        /**
+         * @brief Creates an `Upload_service` instance recording to the transfer queue of the given Context.
+        */
+        explicit Upload_service(Context& context);
+        ~Upload_service();
+
+        Upload_service(const Upload_service& other) = delete;
+        Upload_service& operator=(const Upload_service& other) = delete;
+
+        /**
+         * @brief Stores an upload to the buffer in the open batch.
+         * @details The data is copied, see `Buffer_upload_batch`. Buffers that are not in the `Device`
+         * domain are written directly on `submit()`.
+         * Only meant for the initial contents of `Device` buffers: the buffer must not have been used by
+         * another queue family before, and the whole buffer is released to the destination queue family,
+         * so its contents outside of the uploaded ranges are undefined afterwards. Later updates have to be
+         * recorded on the queue that owns the buffer.
+         * @param dst_queue_family_index The queue family index that uses the buffer after the upload.
+        */
+        void upload_buffer(const Buffer& buffer, const void* data, VkDeviceSize size, VkDeviceSize offset,
+            uint32_t dst_queue_family_index);
+
+        /**
+         * @brief Records an upload of whole mip levels and array layers into the open batch.
+         * @details The data is copied immediately, see `Transfer_command_buffer::upload_image_mip_chain`.
+         * The previous contents of the uploaded subresources are discarded.
+         * @param final_layout The layout of the uploaded subresources after acquiring them.
+         * @param dst_queue_family_index The queue family index that uses the image after the upload.
+        */
+        void upload_image(Image& image, const void* data, uint32_t base_mip_level, uint32_t mip_levels,
+            uint32_t base_layer, uint32_t layers, VkImageLayout final_layout, uint32_t dst_queue_family_index);
+
+        /**
+         * @brief Submits the open batch to the transfer queue.
+         * @return The timeline value signaled once the batch completed, `0` if no uploads were stored.
+        */
+        uint64_t submit();
+
+        /**
+         * @brief Pushes the acquire barriers of the batch signaling the given value.
+         * @details Must be recorded exactly once on the destination queue family before any use of the resources.
+         * The barriers are removed from this instance afterwards.
+        */
+        void push_acquire_barriers(Pipeline_barrier_builder& builder, uint64_t value);
+
+        /**
+         * @brief Returns the wait info for a submission consuming the batch signaling the given value.
+        */
+        Semaphore_signal_info wait_info(uint64_t value, VkPipelineStageFlags2 stage_mask) const;
+
+        /**
+         * @brief Returns whether or not the batch signaling the given value completed on the GPU.
+        */
+        bool is_complete(uint64_t value) const;
+
+        /**
+         * @brief Recycles command buffers and staging memory of completed batches.
+        */
+        void collect();
+
+        /**
+         * @brief Returns the timeline semaphore signaled by every batch.
+        */
+        VkSemaphore timeline() const { return m_timeline; }
+
+    private:
+        struct Pending_batch
+        {
+            uint64_t value;
+            VkCommandBuffer cmdbuf;
+            std::unique_ptr<Linear_host_resource_allocator> allocator;
+        };
+
+        struct Ownership_transfer
+        {
+            VkBuffer buffer;
+            VkImage image;
+            VkImageLayout old_layout;
+            VkImageLayout new_layout;
+            uint32_t dst_queue_family_index;
+            VkImageAspectFlags aspect;
+            uint32_t base_mip_level;
+            uint32_t mip_levels;
+            uint32_t base_layer;
+            uint32_t layers;
+        };
+
+        struct Pending_acquire
+        {
+            uint64_t value;
+            std::vector<Ownership_transfer> transfers;
+        };
+
+        Transfer_command_buffer& open_batch();
+        void push_buffer_release(const Buffer& buffer, uint32_t dst_queue_family_index);
+
+    private:
+        Context& m_context;
+        VmaPool m_pool;
+        Command_buffer_recycler m_command_buffer_recycler;
+        VkSemaphore m_timeline;
+        uint64_t m_next_value = 1;
+
+        std::unique_ptr<Linear_host_resource_allocator> m_open_allocator = nullptr;
+        std::optional<Transfer_command_buffer> m_open_cmdbuf = std::nullopt;
+        Buffer_upload_batch m_buffer_upload_batch = {};
+        std::vector<Ownership_transfer> m_open_transfers = {};
+
+        std::vector<Pending_batch> m_pending_batches = {};
+        std::vector<Pending_acquire> m_pending_acquires = {};
+        std::vector<std::unique_ptr<Linear_host_resource_allocator>> m_free_allocators = {};
+    };
+}
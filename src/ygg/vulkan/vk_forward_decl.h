@@ -30,6 +30,7 @@ YGG_FORWARDDECL_VK_NON_DISPATCHABLE_HANDLE(VkDescriptorSetLayout);
 YGG_FORWARDDECL_VK_NON_DISPATCHABLE_HANDLE(VkSampler);
 YGG_FORWARDDECL_VK_NON_DISPATCHABLE_HANDLE(VkDescriptorSet);
 YGG_FORWARDDECL_VK_NON_DISPATCHABLE_HANDLE(VkDescriptorPool);
+YGG_FORWARDDECL_VK_NON_DISPATCHABLE_HANDLE(VkDescriptorUpdateTemplate);
 YGG_FORWARDDECL_VK_NON_DISPATCHABLE_HANDLE(VkFramebuffer);
 YGG_FORWARDDECL_VK_NON_DISPATCHABLE_HANDLE(VkCommandPool);
 YGG_FORWARDDECL_VK_NON_DISPATCHABLE_HANDLE(VkSwapchainKHR);
@@ -49,6 +50,7 @@ typedef VkFlags VkCullModeFlags;
 typedef VkFlags VkDependencyFlags;
 typedef VkFlags VkDescriptorBindingFlags;
 typedef VkFlags VkDescriptorSetLayoutCreateFlags;
+typedef VkFlags VkGraphicsPipelineLibraryFlagsEXT;
 typedef VkFlags VkImageAspectFlags;
 typedef VkFlags VkImageCreateFlags;
 typedef VkFlags VkImageUsage;
@@ -60,6 +62,7 @@ typedef uint64_t VkFlags64;
 typedef VkFlags64 VkAccessFlags2;
 typedef VkFlags64 VkPipelineStageFlags2;
 
+typedef uint64_t VkDeviceAddress;
 typedef uint64_t VkDeviceSize;
 
 enum VkAttachmentLoadOp : int32_t;
@@ -90,8 +93,11 @@ enum VkTessellationDomainOrigin : int32_t;
 enum VkVertexInputRate : int32_t;
 
 struct VkBufferMemoryBarrier2;
+struct VkDescriptorBufferInfo;
+struct VkDescriptorImageInfo;
 struct VkImageSubresourceRange;
 struct VkImageMemoryBarrier2;
 struct VkMemoryBarrier2;
+struct VkWriteDescriptorSet;
 
 union VkClearValue;
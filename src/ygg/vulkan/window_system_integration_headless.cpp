@@ -0,0 +1,30 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#include "ygg/vulkan/window_system_integration_headless.h"
+
+namespace ygg::vk
+{
+    Window_system_integration_headless::Window_system_integration_headless(uint32_t width, uint32_t height)
+        : m_width(width), m_height(height)
+    {}
+
+    void Window_system_integration_headless::close()
+    {
+        m_is_closed = true;
+    }
+
+    bool Window_system_integration_headless::is_closed() const
+    {
+        return m_is_closed;
+    }
+
+    uint32_t Window_system_integration_headless::get_width() const
+    {
+        return m_width;
+    }
+
+    uint32_t Window_system_integration_headless::get_height() const
+    {
+        return m_height;
+    }
+}
@@ -0,0 +1,51 @@
+// Copyright 2022 Robert Ryan. See Licence.md.
+
+#pragma once
+
+#include "ygg/vulkan/window_system_integration.h"
+
+namespace ygg::vk
+{
+    /**
+     * @brief Headless implementation of Vulkan WSI.
+     * @details Does not create a surface and does not require any instance or device extensions.
+     * A Context bound to this WSI has no surface, which means no Swapchain can be created for it.
+     * Rendering is done into offscreen images instead, see Offscreen_swapchain.
+     * This works on any platform, including software implementations such as lavapipe.
+    */
+    class Window_system_integration_headless : public Window_system_integration
+    {
+    public:
+        /**
+         * @brief Creates a headless WSI-instance.
+         * @param width The width reported for the virtual surface.
+         * @param height The height reported for the virtual surface.
+        */
+        Window_system_integration_headless(uint32_t width, uint32_t height);
+
+        /**
+         * @brief Marks the virtual surface as closed.
+        */
+        void close();
+
+        /**
+         * @brief Query whether or not `close()` has been called.
+        */
+        virtual bool is_closed() const override;
+
+        /**
+         * @brief Query the virtual surface width.
+        */
+        virtual uint32_t get_width() const override;
+
+        /**
+         * @brief Query the virtual surface height.
+        */
+        virtual uint32_t get_height() const override;
+
+    private:
+        uint32_t m_width;
+        uint32_t m_height;
+        bool m_is_closed = false;
+    };
+}
@@ -1,6 +1,6 @@
 // Copyright 2022 Robert Ryan. See Licence.md.
 
-#include "ygg/window/Window_win32.h"
+#include "ygg/window/window_win32.h"
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
 #define WIN32_LEAN_AND_MEAN
@@ -5,19 +5,70 @@
 #include <volk.h>
 #include <ygg/common/file_util.h>
 #include <ygg/vulkan/glsl_compiler.h>
+#include <ygg/vulkan/spirv_reflection.h>
+#include <ygg/vulkan/window_system_integration_headless.h>
+#include <ygg/vulkan/window_system_integration_win32.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace ygg::mini_sample
 {
-    Base_app::Base_app(uint32_t window_width, uint32_t window_height, const std::string& title)
-        : m_clock(), m_window(window_width, window_height, title.c_str()),
-        m_wsi(m_window), m_context(m_wsi), m_swapchain(m_context, m_wsi)
+    bool select_headless([[maybe_unused]] const Base_app_info& info)
     {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+        return info.headless_frame_count > 0;
+#else
+        return true;
+#endif
+    }
+
+    std::unique_ptr<Window_win32> create_window([[maybe_unused]] const Base_app_info& info, [[maybe_unused]] bool headless)
+    {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+        if (!headless) {
+            return std::make_unique<Window_win32>(info.window_width, info.window_height, info.title.c_str());
+        }
+#endif
+        return nullptr;
+    }
+
+    std::unique_ptr<vk::Window_system_integration> create_wsi(const Base_app_info& info, [[maybe_unused]] const Window_win32* window)
+    {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+        if (window) {
+            return std::make_unique<vk::Window_system_integration_win32>(*window);
+        }
+#endif
+        return std::make_unique<vk::Window_system_integration_headless>(info.window_width, info.window_height);
+    }
+
+    Base_app::Base_app(const Base_app_info& info)
+        : m_clock(), m_headless(select_headless(info)), m_headless_frame_count(info.headless_frame_count),
+        m_window(create_window(info, m_headless)), m_wsi(create_wsi(info, m_window.get())),
+        m_context(*m_wsi, { .max_frames_in_flight = info.max_frames_in_flight, .low_latency = info.low_latency }),
+        m_shader_compiler(info.shader_compiler_threads), m_spirv_cache(info.spirv_cache_directory),
+        m_shader_watcher(info.shader_hot_reload ? std::make_unique<util::File_watcher>() : nullptr)
+    {
+        if (m_headless) {
+            m_offscreen_swapchain = std::make_unique<vk::Offscreen_swapchain>(m_context, *m_wsi);
+        }
+        else {
+            m_swapchain = std::make_unique<vk::Swapchain>(m_context, *m_wsi);
+        }
+        m_upload_service = std::make_unique<vk::Upload_service>(m_context);
         vk::glsl_compiler::init();
     }
 
     Base_app::~Base_app()
     {
         m_context.device_wait_idle();
+        m_upload_service.reset();
         for (auto& b : m_buffers) {
             m_context.destroy_buffer(b);
         }
@@ -30,8 +81,18 @@ namespace ygg::mini_sample
         for (auto p : m_pipeline_layouts) {
             m_context.destroy_pipeline_layout(p);
         }
+        for (auto t : m_descriptor_update_templates) {
+            m_context.destroy_descriptor_update_template(t);
+        }
         for (auto& p : m_graphics_pipelines) {
-            m_context.destroy_pipeline(p.pipeline);
+            if (p.reload.has_value()) {
+                swap_reloaded_pipeline(p);
+            }
+            auto pipeline = p.pipeline.wait();
+            m_context.destroy_pipeline(pipeline);
+            if (p.reflected_layout.has_value()) {
+                m_context.destroy_pipeline_layout(p.reflected_layout.value());
+            }
             auto& program = p.create_info.info.program;
             if (program.vert.handle) {
                 m_context.destroy_shader_module(program.vert);
@@ -59,15 +120,15 @@ namespace ygg::mini_sample
         frame_loop();
     }
 
-    Buffer_handle Base_app::create_managed_buffer(const vk::Buffer_info& info)
+    Buffer_handle Base_app::create_managed_buffer(const vk::Buffer_info& info, bool bindless)
     {
-        m_buffers.push_back(m_context.create_buffer(info, m_context.graphics_queue().queue_family_index));
+        m_buffers.push_back(m_context.create_buffer(info, m_context.graphics_queue().queue_family_index, bindless));
         return Buffer_handle(m_buffers.size() - 1ull);
     }
 
-    Image_handle Base_app::create_managed_image(const vk::Image_info& info)
+    Image_handle Base_app::create_managed_image(const vk::Image_info& info, bool bindless)
     {
-        m_images.push_back(m_context.create_image(info, m_context.graphics_queue().queue_family_index));
+        m_images.push_back(m_context.create_image(info, m_context.graphics_queue().queue_family_index, bindless));
         return Image_handle(m_images.size() - 1ull);
     }
 
@@ -83,6 +144,13 @@ namespace ygg::mini_sample
         return m_pipeline_layouts.at(m_pipeline_layouts.size() - 1ull);
     }
 
+    VkDescriptorUpdateTemplate Base_app::create_managed_descriptor_update_template(
+        const vk::Descriptor_update_template_info& info)
+    {
+        m_descriptor_update_templates.push_back(m_context.create_descriptor_update_template(info));
+        return m_descriptor_update_templates.at(m_descriptor_update_templates.size() - 1ull);
+    }
+
     std::vector<uint32_t> compile_vert_shader_fail()
     {
         std::string vert_fail_code = "#version 460 core\n"
@@ -99,29 +167,58 @@ namespace ygg::mini_sample
         return vk::glsl_compiler::compile_spirv_1_6_unchecked(frag_fail_code, VK_SHADER_STAGE_FRAGMENT_BIT);
     }
 
-    Graphics_pipeline_handle Base_app::create_managed_graphics_pipeline(const Graphics_pipeline_create_info& info)
+    constexpr std::array<VkShaderStageFlagBits, detail::GRAPHICS_STAGE_COUNT> GRAPHICS_STAGES = {
+        VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT };
+    constexpr std::array<const char*, detail::GRAPHICS_STAGE_COUNT> GRAPHICS_STAGE_NAMES = { "vert", "frag" };
+
+    const std::string& graphics_stage_path(const Graphics_pipeline_path_info& paths, std::size_t stage)
     {
-        Graphics_pipeline_create_info create_info = info;
-        auto& vk_create_info = create_info.info;
-        vk::Graphics_program program = {};
+        return stage == 0 ? paths.vert : paths.frag;
+    }
+
+    vk::Shader_module& graphics_stage_module(vk::Graphics_program& program, std::size_t stage)
+    {
+        return stage == 0 ? program.vert : program.frag;
+    }
 
+    /**
+     * @brief Reads the source of a stage into a compile job. Includes are resolved relative to the source.
+    */
+    std::optional<vk::glsl_compiler::Compile_job> read_graphics_stage_job(const Graphics_pipeline_path_info& paths,
+        std::size_t stage)
+    {
+        const auto& path = graphics_stage_path(paths, stage);
         try {
-            auto vert_code = file_util::file_to_str(info.paths.vert);
-            std::vector<uint32_t> spirv = {};
-            try {
-                spirv = vk::glsl_compiler::compile_spirv_1_6(vert_code, VK_SHADER_STAGE_VERTEX_BIT);
-            }
-            catch (const vk::glsl_compiler::Glsl_compiler_error& e) {
-                printf("Glsl compiler error.\nfile: '%s'\nmsg: '%s'\n", info.paths.vert.c_str(), e.what());
-                spirv = compile_vert_shader_fail();
-            }
-            program.vert = m_context.create_shader_module(spirv, VK_SHADER_STAGE_VERTEX_BIT);
+            return vk::glsl_compiler::Compile_job{
+                .code = file_util::file_to_str(path),
+                .shader_stage = VkShaderStageFlags(GRAPHICS_STAGES[stage]),
+                .include_dirs = { std::filesystem::path(path).parent_path().string() }
+            };
         }
         catch (const file_util::IO_error& e) {
-            printf("Glsl compiler file read error (vert).\n%s\n", e.what());
-            std::vector<uint32_t> spirv = compile_vert_shader_fail();
-            program.vert = m_context.create_shader_module(spirv, VK_SHADER_STAGE_VERTEX_BIT);
+            printf("Glsl compiler file read error (%s).\n%s\n", GRAPHICS_STAGE_NAMES[stage], e.what());
+            return std::nullopt;
         }
+    }
+
+    /**
+     * @brief Returns the normalized paths of the source of a stage and all files it included.
+    */
+    std::vector<std::string> graphics_stage_dependencies(const Graphics_pipeline_path_info& paths, std::size_t stage,
+        const vk::Spirv_cache::Batch_result& result)
+    {
+        std::vector<std::string> dependencies = { util::File_watcher::normalize_path(graphics_stage_path(paths, stage)) };
+        for (const auto& include : result.includes) {
+            dependencies.push_back(util::File_watcher::normalize_path(include));
+        }
+        return dependencies;
+    }
+
+    Graphics_pipeline_handle Base_app::create_managed_graphics_pipeline(const Graphics_pipeline_create_info& info)
+    {
+        Graphics_pipeline_create_info create_info = info;
+        auto& vk_create_info = create_info.info;
+        vk::Graphics_program program = {};
 
         if (info.paths.tesc.size()) {
             assert(false && "Not yet supported.");
@@ -135,28 +232,76 @@ namespace ygg::mini_sample
             assert(false && "Not yet supported.");
         }
 
-        try {
-            auto frag_code = file_util::file_to_str(info.paths.frag);
-            std::vector<uint32_t> spirv = {};
-            try {
-                spirv = vk::glsl_compiler::compile_spirv_1_6(frag_code, VK_SHADER_STAGE_FRAGMENT_BIT);
+        const std::array<std::vector<uint32_t>(*)(), detail::GRAPHICS_STAGE_COUNT> compile_fail = {
+            compile_vert_shader_fail, compile_frag_shader_fail };
+
+        std::vector<vk::glsl_compiler::Compile_job> jobs = {};
+        std::array<std::optional<std::size_t>, detail::GRAPHICS_STAGE_COUNT> job_indices = {};
+        for (std::size_t i = 0; i < detail::GRAPHICS_STAGE_COUNT; i++) {
+            if (auto job = read_graphics_stage_job(info.paths, i); job.has_value()) {
+                jobs.push_back(std::move(job.value()));
+                job_indices[i] = jobs.size() - 1;
+            }
+        }
+
+        // All stages compile concurrently, stages that fail to load or compile are replaced by a fallback.
+        auto results = m_spirv_cache.compile_spirv_1_6_batch(jobs, m_shader_compiler);
+        std::array<std::vector<uint32_t>, detail::GRAPHICS_STAGE_COUNT> spirv = {};
+        std::array<std::vector<std::string>, detail::GRAPHICS_STAGE_COUNT> stage_dependencies = {};
+        for (std::size_t i = 0; i < detail::GRAPHICS_STAGE_COUNT; i++) {
+            // Failed stages are still watched, so fixing them rebuilds the pipeline.
+            stage_dependencies[i] = { util::File_watcher::normalize_path(graphics_stage_path(info.paths, i)) };
+            if (!job_indices[i].has_value()) {
+                spirv[i] = compile_fail[i]();
+                continue;
             }
-            catch (const vk::glsl_compiler::Glsl_compiler_error& e) {
-                printf("Glsl compiler error.\nfile: '%s'\nmsg: '%s'\n", info.paths.frag.c_str(), e.what());
-                spirv = compile_frag_shader_fail();
+            auto& result = results[job_indices[i].value()];
+            if (result.error.has_value()) {
+                printf("Glsl compiler error.\nfile: '%s'\nmsg: '%s'\n", graphics_stage_path(info.paths, i).c_str(),
+                    result.error->c_str());
+                spirv[i] = compile_fail[i]();
+            }
+            else {
+                spirv[i] = std::move(result.spirv);
+                stage_dependencies[i] = graphics_stage_dependencies(info.paths, i, result);
             }
-            program.frag = m_context.create_shader_module(spirv, VK_SHADER_STAGE_FRAGMENT_BIT);
         }
-        catch (const file_util::IO_error& e) {
-            printf("Glsl compiler file read error (frag).\n%s\n", e.what());
-            std::vector<uint32_t> spirv = compile_frag_shader_fail();
-            program.frag = m_context.create_shader_module(spirv, VK_SHADER_STAGE_FRAGMENT_BIT);
+        program.vert = m_context.create_shader_module(spirv[0], GRAPHICS_STAGES[0]);
+        program.frag = m_context.create_shader_module(spirv[1], GRAPHICS_STAGES[1]);
+
+        std::optional<vk::Reflected_pipeline_layout> reflected_layout = std::nullopt;
+        std::array<vk::Shader_reflection, detail::GRAPHICS_STAGE_COUNT> stage_reflections = {};
+        if (vk_create_info.layout == nullptr) {
+            for (std::size_t i = 0; i < detail::GRAPHICS_STAGE_COUNT; i++) {
+                auto stage_reflection = vk::reflect_spirv(spirv[i]);
+                if (!stage_reflection.has_value()) {
+                    printf("Spirv reflection failed.\nfile: '%s'\n", graphics_stage_path(info.paths, i).c_str());
+                    std::abort();
+                }
+                stage_reflections[i] = std::move(stage_reflection.value());
+            }
+            auto reflection = stage_reflections[0];
+            vk::merge_shader_reflection(reflection, stage_reflections[1]);
+            reflected_layout = m_context.create_pipeline_layout(reflection);
+            vk_create_info.layout = reflected_layout.value().layout;
+        }
+
+        if (m_shader_watcher) {
+            for (const auto& dependencies : stage_dependencies) {
+                for (const auto& dependency : dependencies) {
+                    m_shader_watcher->watch(dependency);
+                }
+            }
         }
 
         vk_create_info.program = program;
         detail::Graphics_pipeline pipeline = {
             .create_info = create_info,
-            .pipeline = m_context.create_graphics_pipeline(vk_create_info)
+            .pipeline = m_context.create_graphics_pipeline_async(vk_create_info),
+            .reflected_layout = std::move(reflected_layout),
+            .stage_dependencies = std::move(stage_dependencies),
+            .stage_reflections = std::move(stage_reflections),
+            .reload = std::nullopt
         };
         m_graphics_pipelines.push_back(pipeline);
         return Graphics_pipeline_handle(m_graphics_pipelines.size() - 1ull);
@@ -167,11 +312,37 @@ namespace ygg::mini_sample
         m_context.update_descriptor_set(info);
     }
 
-    void Base_app::update_descriptor_sets(std::span<vk::Descriptor_set_write_info> infos)
+    void Base_app::update_descriptor_sets(std::span<const vk::Descriptor_set_write_info> infos)
     {
         m_context.update_descriptor_sets(infos);
     }
 
+    void Base_app::batch_descriptor_set_write(const vk::Descriptor_set_write_info& info)
+    {
+        m_context.batch_descriptor_set_write(info);
+    }
+
+    void Base_app::batch_descriptor_set_writes(std::span<const vk::Descriptor_set_write_info> infos)
+    {
+        m_context.batch_descriptor_set_writes(infos);
+    }
+
+    void Base_app::flush_descriptor_writes()
+    {
+        m_context.flush_descriptor_writes();
+    }
+
+    void Base_app::update_descriptor_set_with_template(VkDescriptorSet set,
+        VkDescriptorUpdateTemplate update_template, const void* data)
+    {
+        m_context.update_descriptor_set_with_template(set, update_template, data);
+    }
+
+    VkImageLayout Base_app::present_layout() const
+    {
+        return m_headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    }
+
     vk::Descriptor_buffer_info Base_app::descriptor_buffer_info(Buffer_handle buffer, VkDeviceSize offset, VkDeviceSize size)
     {
         return {
@@ -183,77 +354,222 @@ namespace ygg::mini_sample
 
     void Base_app::add_initial_upload(const Buffer_upload& buffer_upload)
     {
-        void* data = malloc(buffer_upload.size);
-        if (!data) {
-            std::abort();
-        }
-        memcpy(data, buffer_upload.data, buffer_upload.size);
-        Buffer_upload u = {
-            .dst = buffer_upload.dst,
-            .data = data,
-            .size = buffer_upload.size,
-            .offset = buffer_upload.offset
-        };
-        m_buffer_uploads.push_back(u);
+        m_upload_service->upload_buffer(buf_from_handle(buffer_upload.dst), buffer_upload.data,
+            buffer_upload.size, buffer_upload.offset, m_context.graphics_queue().queue_family_index);
     }
 
     void Base_app::add_initial_upload(const Image_upload& image_upload)
     {
-        m_image_uploads.push_back(image_upload);
+        m_upload_service->upload_image(img_from_handle(image_upload.dst), image_upload.data,
+            image_upload.base_mip_level, image_upload.mip_levels, image_upload.base_layer, image_upload.layers,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_context.graphics_queue().queue_family_index);
     }
 
-    void Base_app::upload_data(vk::Graphics_command_buffer& cmdbuf)
+    void Base_app::upload_data(vk::Graphics_command_buffer& cmdbuf, std::vector<vk::Semaphore_signal_info>& await_sema_infos)
     {
-        bool has_uploads = m_buffer_uploads.size() > 0 || m_image_uploads.size() > 0;
-        if (!has_uploads)
+        uint64_t upload_value = m_upload_service->submit();
+        if (upload_value == 0)
             return;
 
-        for (const auto& buf_upload : m_buffer_uploads) {
-            cmdbuf.upload_buffer_data(buf_from_handle(buf_upload.dst),
-                buf_upload.data, buf_upload.size, buf_upload.offset);
-            free(buf_upload.data);
+        // Only this submission consumes the uploads, later submissions to the graphics queue are ordered after it.
+        m_upload_service->push_acquire_barriers(cmdbuf.pipeline_barrier_builder(), upload_value);
+        cmdbuf.pipeline_barrier_builder().flush(0);
+        await_sema_infos.push_back(m_upload_service->wait_info(upload_value, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT));
+    }
+
+    void Base_app::reload_shaders()
+    {
+        for (auto& pipeline : m_graphics_pipelines) {
+            if (pipeline.reload.has_value() && pipeline.reload->pipeline.is_ready()) {
+                swap_reloaded_pipeline(pipeline);
+            }
+        }
+
+        if (!m_shader_watcher) {
+            return;
+        }
+        auto changes = m_shader_watcher->poll_changes();
+        if (changes.empty()) {
+            return;
+        }
+        std::unordered_set<std::string> changed_files(changes.begin(), changes.end());
+
+        struct Stage_reload
+        {
+            std::size_t pipeline_index;
+            std::size_t stage;
+            std::size_t job_index;
+        };
+
+        // Only stages depending on a changed file are recompiled, the jobs of all pipelines compile concurrently.
+        std::vector<vk::glsl_compiler::Compile_job> jobs = {};
+        std::vector<Stage_reload> stage_reloads = {};
+        for (std::size_t i = 0; i < m_graphics_pipelines.size(); i++) {
+            auto& pipeline = m_graphics_pipelines[i];
+            for (std::size_t stage = 0; stage < detail::GRAPHICS_STAGE_COUNT; stage++) {
+                const auto& dependencies = pipeline.stage_dependencies[stage];
+                bool is_affected = std::any_of(dependencies.begin(), dependencies.end(),
+                    [&](const std::string& dependency) { return changed_files.contains(dependency); });
+                if (!is_affected) {
+                    continue;
+                }
+                if (auto job = read_graphics_stage_job(pipeline.create_info.paths, stage); job.has_value()) {
+                    jobs.push_back(std::move(job.value()));
+                    stage_reloads.push_back({ .pipeline_index = i, .stage = stage, .job_index = jobs.size() - 1 });
+                }
+            }
+        }
+        if (jobs.empty()) {
+            return;
+        }
+        auto results = m_spirv_cache.compile_spirv_1_6_batch(jobs, m_shader_compiler);
+
+        // Pipelines with a failing stage keep running with their previous shaders.
+        std::unordered_set<std::size_t> failed_pipelines = {};
+        std::vector<std::optional<vk::Shader_reflection>> reflections(jobs.size());
+        for (const auto& stage_reload : stage_reloads) {
+            const auto& result = results[stage_reload.job_index];
+            const auto& pipeline = m_graphics_pipelines[stage_reload.pipeline_index];
+            const auto& path = graphics_stage_path(pipeline.create_info.paths, stage_reload.stage);
+            if (result.error.has_value()) {
+                printf("Glsl compiler error, keeping the previous shader.\nfile: '%s'\nmsg: '%s'\n",
+                    path.c_str(), result.error->c_str());
+                failed_pipelines.insert(stage_reload.pipeline_index);
+                continue;
+            }
+            if (pipeline.reflected_layout.has_value()) {
+                reflections[stage_reload.job_index] = vk::reflect_spirv(result.spirv);
+                if (!reflections[stage_reload.job_index].has_value()) {
+                    printf("Spirv reflection failed, keeping the previous shader.\nfile: '%s'\n", path.c_str());
+                    failed_pipelines.insert(stage_reload.pipeline_index);
+                }
+            }
+        }
+
+        std::unordered_map<std::size_t, detail::Graphics_pipeline_reload> reloads = {};
+        for (auto& stage_reload : stage_reloads) {
+            if (failed_pipelines.contains(stage_reload.pipeline_index)) {
+                continue;
+            }
+            auto& pipeline = m_graphics_pipelines[stage_reload.pipeline_index];
+            if (pipeline.reload.has_value()) {
+                // A previous reload of the pipeline is still compiling, the new one builds upon it.
+                pipeline.reload->pipeline.wait();
+                swap_reloaded_pipeline(pipeline);
+            }
+            auto [it, inserted] = reloads.try_emplace(stage_reload.pipeline_index, detail::Graphics_pipeline_reload{
+                .pipeline = {},
+                .program = pipeline.create_info.info.program,
+                .stage_dependencies = pipeline.stage_dependencies,
+                .stage_reflections = pipeline.stage_reflections
+                });
+            auto& result = results[stage_reload.job_index];
+            if (pipeline.reflected_layout.has_value()) {
+                it->second.stage_reflections[stage_reload.stage] =
+                    std::move(reflections[stage_reload.job_index].value());
+            }
+            graphics_stage_module(it->second.program, stage_reload.stage) =
+                m_context.create_shader_module(result.spirv, GRAPHICS_STAGES[stage_reload.stage]);
+            it->second.stage_dependencies[stage_reload.stage] =
+                graphics_stage_dependencies(pipeline.create_info.paths, stage_reload.stage, result);
+            for (const auto& dependency : it->second.stage_dependencies[stage_reload.stage]) {
+                m_shader_watcher->watch(dependency);
+            }
         }
-        m_buffer_uploads.clear();
-        for (const auto& img_upload : m_image_uploads) {
-            img_upload;
-            assert(false);
+
+        for (auto& [index, reload] : reloads) {
+            auto& pipeline = m_graphics_pipelines[index];
+            if (pipeline.reflected_layout.has_value() && !is_reflected_layout_unchanged(pipeline, reload)) {
+                printf("Shader interface changed, keeping the previous shaders.\nvert: '%s'\nfrag: '%s'\n",
+                    pipeline.create_info.paths.vert.c_str(), pipeline.create_info.paths.frag.c_str());
+                for (std::size_t stage = 0; stage < detail::GRAPHICS_STAGE_COUNT; stage++) {
+                    auto& module = graphics_stage_module(reload.program, stage);
+                    if (module.handle != graphics_stage_module(pipeline.create_info.info.program, stage).handle) {
+                        m_context.destroy_shader_module(module);
+                    }
+                }
+                continue;
+            }
+            auto info = pipeline.create_info.info;
+            info.program = reload.program;
+            reload.pipeline = m_context.create_graphics_pipeline_async(info);
+            pipeline.reload = std::move(reload);
         }
-        m_image_uploads.clear();
-        cmdbuf.pipeline_barrier_builder()
-            .push_memory_barrier(
-                VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_WRITE_BIT,
-                VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT
-            )
-            .flush(0);
+    }
+
+    bool Base_app::is_reflected_layout_unchanged(const detail::Graphics_pipeline& pipeline,
+        const detail::Graphics_pipeline_reload& reload)
+    {
+        auto reflection = reload.stage_reflections[0];
+        vk::merge_shader_reflection(reflection, reload.stage_reflections[1]);
+        // Equal layouts are the same handle in the layout cache, so comparing handles compares the interfaces.
+        // The reflected layout still holds its references, so only a differing new layout is destroyed.
+        auto layout = m_context.create_pipeline_layout(reflection);
+        bool unchanged = layout.layout == pipeline.reflected_layout.value().layout;
+        m_context.destroy_pipeline_layout(layout);
+        return unchanged;
+    }
+
+    void Base_app::swap_reloaded_pipeline(detail::Graphics_pipeline& pipeline)
+    {
+        auto& reload = pipeline.reload.value();
+        m_context.zombify_pipeline(pipeline.pipeline.wait());
+        auto& program = pipeline.create_info.info.program;
+        for (std::size_t stage = 0; stage < detail::GRAPHICS_STAGE_COUNT; stage++) {
+            const auto& module = graphics_stage_module(program, stage);
+            if (module.handle != graphics_stage_module(reload.program, stage).handle) {
+                m_context.zombify_shader_module(module);
+            }
+        }
+        pipeline.pipeline = reload.pipeline;
+        program = reload.program;
+        pipeline.stage_dependencies = std::move(reload.stage_dependencies);
+        pipeline.stage_reflections = std::move(reload.stage_reflections);
+        pipeline.reload.reset();
     }
 
     void Base_app::frame_loop()
     {
-        while (!m_window.window_data().is_closed) {
-            m_window.update();
+        uint32_t frame_count = 0;
+        auto loop_start = std::chrono::steady_clock::now();
+        while (is_running(frame_count)) {
+            if (m_context.is_low_latency()) {
+                m_context.wait_for_previous_frame();
+            }
+            if (m_window) {
+                m_window->update();
+            }
             m_context.begin_frame();
+            reload_shaders();
+            m_upload_service->collect();
             std::vector<VkCommandBuffer> submit_cmdbufs = {};
+            std::vector<vk::Semaphore_signal_info> await_sema_infos = {};
 
             auto cmdbuf = m_context.frame_context().acquire_graphics_command_buffer();
             cmdbuf.begin();
-            upload_data(cmdbuf);
+            upload_data(cmdbuf, await_sema_infos);
             render(cmdbuf, m_context.frame_context(), m_clock);
             submit_cmdbufs.emplace_back(cmdbuf.handle());
 
-            std::vector<vk::Semaphore_signal_info> await_sema_infos = {};
             bool has_blitted_to_swapchain = false;
-            auto& window_data = m_window.window_data();
-            bool can_use_swapchain = window_data.height > 0 && window_data.width > 0;
+            bool can_use_swapchain = !m_headless && surface_width() > 0 && surface_height() > 0;
             VkSemaphore acquire_semaphore = VK_NULL_HANDLE;
-            if (can_use_swapchain) {
+            if (m_headless) {
+                m_offscreen_swapchain->acquire();
+                auto offscreen_img = m_offscreen_swapchain->image();
+                if (offscreen_img.allocated_image.handle) {
+                    swapchain_pass(cmdbuf, offscreen_img);
+                }
+            }
+            else if (can_use_swapchain) {
                 acquire_semaphore = m_context.create_binary_semaphore();
                 m_context.frame_context().zombify_semaphore(acquire_semaphore);
-                auto acquire_result = m_swapchain.try_acquire_index_recreate_on_resize(acquire_semaphore);
+                auto acquire_result = m_swapchain->try_acquire_index_recreate_on_resize(acquire_semaphore);
                 if (acquire_result != VK_SUCCESS) {
                     printf("\nUnrecoverable swapchain acquire error. VkResult: %i\n\n", acquire_result);
                     std::abort();
                 }
-                auto swapchain_img = m_swapchain.image();
+                auto swapchain_img = m_swapchain->image();
                 swapchain_pass(cmdbuf, swapchain_img);
                 has_blitted_to_swapchain = true;
                 await_sema_infos.emplace_back(vk::Semaphore_signal_info{
@@ -275,16 +591,17 @@ namespace ygg::mini_sample
                     .stage_mask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
                     });
             }
+            signal_sema_infos.emplace_back(m_context.frame_completion_signal_info());
 
             vk::Submit submit_info = {
                 .await_semas = { await_sema_infos },
                 .cmd_bufs = { submit_cmdbufs },
                 .signal_semas = { signal_sema_infos }
             };
-            m_context.submit(m_context.graphics_queue().queue, submit_info, m_context.frame_fence());
+            m_context.submit(m_context.graphics_queue().queue, submit_info, VK_NULL_HANDLE);
 
             if (can_use_swapchain && has_blitted_to_swapchain) {
-                auto present_result = m_swapchain.try_present_recreate_on_resize(
+                auto present_result = m_swapchain->try_present_recreate_on_resize(
                     m_context.graphics_queue().queue, submit_semaphore);
                 if (present_result != VK_SUCCESS) {
                     printf("\nUnrecoverable swapchain present error. VkResult: %i\n\n", present_result);
@@ -294,7 +611,23 @@ namespace ygg::mini_sample
 
             m_context.end_frame();
             m_clock.next_clock_frame();
+            frame_count++;
+        }
+
+        if (m_headless) {
+            m_context.device_wait_idle();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - loop_start;
+            printf("Headless run finished: %u frames in %.3f s (%.3f ms/frame).\n",
+                frame_count, elapsed.count(), frame_count > 0 ? 1000.0 * elapsed.count() / frame_count : 0.0);
+        }
+    }
+
+    bool Base_app::is_running(uint32_t frame_count) const
+    {
+        if (m_headless) {
+            return m_headless_frame_count == 0 || frame_count < m_headless_frame_count;
         }
+        return !m_wsi->is_closed();
     }
 
     vk::Allocated_buffer Base_app::select_allocated_buffer(Buffer_handle buf)
@@ -4,13 +4,21 @@
 
 #include <ygg/common/handle.h>
 #include <ygg/util/clock.h>
+#include <ygg/util/file_watcher.h>
 #include <ygg/vulkan/context.h>
+#include <ygg/vulkan/glsl_batch_compiler.h>
 #include <ygg/vulkan/graphics_command_buffer.h>
+#include <ygg/vulkan/offscreen_swapchain.h>
+#include <ygg/vulkan/spirv_cache.h>
 #include <ygg/vulkan/swapchain.h>
-#include <ygg/vulkan/window_system_integration_win32.h>
+#include <ygg/vulkan/upload_service.h>
+#include <ygg/vulkan/window_system_integration.h>
 #include <ygg/window/window_win32.h>
 
 #include <glm/glm.hpp>
+#include <array>
+#include <memory>
+#include <optional>
 #include <vector>
 
 namespace ygg::mini_sample
@@ -30,6 +38,8 @@ namespace ygg::mini_sample
 
         /**
          * Skip vk::Graphics_pipeline_info::program. Use paths instead.
+         * If vk::Graphics_pipeline_info::layout is null, the layout is reflected from the shaders
+         * and created through the layout cache of the context.
         */
         vk::Graphics_pipeline_info info;
     };
@@ -52,10 +62,38 @@ namespace ygg::mini_sample
         struct Graphics_pipeline_tag {};
         struct Compute_pipeline_tag {};
 
+        /**
+         * The vertex and fragment stage, in this order.
+        */
+        constexpr static std::size_t GRAPHICS_STAGE_COUNT = 2;
+
+        /**
+         * A rebuilt pipeline waiting to replace the current one once it is compiled.
+        */
+        struct Graphics_pipeline_reload
+        {
+            vk::Async_pipeline pipeline;
+            vk::Graphics_program program;
+            std::array<std::vector<std::string>, GRAPHICS_STAGE_COUNT> stage_dependencies;
+            std::array<vk::Shader_reflection, GRAPHICS_STAGE_COUNT> stage_reflections;
+        };
+
         struct Graphics_pipeline
         {
             Graphics_pipeline_create_info create_info;
-            vk::Pipeline pipeline;
+            vk::Async_pipeline pipeline;
+            std::optional<vk::Reflected_pipeline_layout> reflected_layout;
+
+            /**
+             * Normalized paths of the source of every stage and the files it included.
+            */
+            std::array<std::vector<std::string>, GRAPHICS_STAGE_COUNT> stage_dependencies;
+
+            /**
+             * Reflection of every stage, only set if the layout was reflected.
+            */
+            std::array<vk::Shader_reflection, GRAPHICS_STAGE_COUNT> stage_reflections;
+            std::optional<Graphics_pipeline_reload> reload;
         };
 
         struct Compute_pipeline
@@ -79,19 +117,59 @@ namespace ygg::mini_sample
         std::size_t offset = 0;
     };
 
+    /**
+     * @brief Upload of whole mip levels and array layers of an image.
+     * @details `data` contains the tightly packed mip levels in ascending order, each holding all array layers.
+     * The size is derived from the image, see `vk::img_utils::get_mip_chain_size`. The data is copied
+     * when added, the image is in `VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL` after the upload.
+    */
     struct Image_upload
     {
         Image_handle dst;
-        void* data;
-        uint32_t width;
-        uint32_t height;
-        uint32_t depth = 1;
-        uint32_t width_offset = 0;
-        uint32_t height_offset = 0;
-        uint32_t depth_offset = 0;
-        uint32_t layers = 1;
+        const void* data;
+        uint32_t base_mip_level = 0;
+        uint32_t mip_levels = 1;
         uint32_t base_layer = 0;
-        uint32_t mip_level = 0;
+        uint32_t layers = 1;
+    };
+
+    struct Base_app_info
+    {
+        uint32_t window_width;
+        uint32_t window_height;
+        std::string title;
+
+        /**
+         * If not zero, the application runs without a window for the given amount of frames
+         * and renders into offscreen images instead of a swapchain.
+         * Platforms without windowing support always run headless, zero then means running until killed.
+        */
+        uint32_t headless_frame_count = 0;
+
+        /**
+         * See `vk::Context_info`.
+        */
+        uint32_t max_frames_in_flight = 2;
+        bool low_latency = false;
+
+        /**
+         * Directory of the on-disk Spirv cache. If empty, compiled shaders are only cached in memory.
+        */
+        std::string spirv_cache_directory = "";
+
+        /**
+         * Amount of threads compiling shaders. If zero, one thread per hardware thread is used.
+        */
+        uint32_t shader_compiler_threads = 0;
+
+        /**
+         * Watches the shader sources of managed pipelines and the files they include. If one changes, only the
+         * stages depending on it are recompiled and the affected pipelines are swapped at the next frame
+         * boundary. Stages that fail to compile keep their previous shader. Reflected layouts are not rebuilt,
+         * reloads changing the layout of a reflected pipeline are rejected. The resource interface of pipelines
+         * with an explicit layout must not change.
+        */
+        bool shader_hot_reload = false;
     };
 
     /**
@@ -100,7 +178,7 @@ namespace ygg::mini_sample
     class Base_app
     {
     public:
-        Base_app(uint32_t window_width, uint32_t window_height, const std::string& title);
+        Base_app(const Base_app_info& info);
         virtual ~Base_app();
 
         Base_app(const Base_app& other) = delete;
@@ -115,19 +193,51 @@ namespace ygg::mini_sample
         virtual void swapchain_pass(vk::Graphics_command_buffer& cmdbuf, vk::Image& swapchain_img) = 0;
         virtual void cleanup() {};
 
-        Buffer_handle create_managed_buffer(const vk::Buffer_info& info);
-        Image_handle create_managed_image(const vk::Image_info& info);
+        Buffer_handle create_managed_buffer(const vk::Buffer_info& info, bool bindless = false);
+        Image_handle create_managed_image(const vk::Image_info& info, bool bindless = false);
         VkDescriptorSetLayout create_managed_descriptor_set_layout(const vk::Descriptor_set_layout_info& info);
         VkPipelineLayout create_managed_pipeline_layout(const vk::Pipeline_layout_info& info);
+        VkDescriptorUpdateTemplate create_managed_descriptor_update_template(const vk::Descriptor_update_template_info& info);
         Graphics_pipeline_handle create_managed_graphics_pipeline(const Graphics_pipeline_create_info& info);
         void update_descriptor_set(const vk::Descriptor_set_write_info& info);
-        void update_descriptor_sets(std::span<vk::Descriptor_set_write_info> infos);
+        void update_descriptor_sets(std::span<const vk::Descriptor_set_write_info> infos);
+
+        /**
+         * @brief Batched writes are applied by `flush_descriptor_writes`, which must be called before binding the sets.
+        */
+        void batch_descriptor_set_write(const vk::Descriptor_set_write_info& info);
+        void batch_descriptor_set_writes(std::span<const vk::Descriptor_set_write_info> infos);
+        void flush_descriptor_writes();
+        void update_descriptor_set_with_template(VkDescriptorSet set, VkDescriptorUpdateTemplate update_template,
+            const void* data);
 
         vk::Buffer& buf_from_handle(Buffer_handle buf) { return m_buffers.at(std::size_t(buf)); };
         vk::Image& img_from_handle(Image_handle img) { return m_images.at(std::size_t(img)); };
-        vk::Pipeline& pipeline_from_handle(Graphics_pipeline_handle p) { return m_graphics_pipelines.at(std::size_t(p)).pipeline; };
+
+        /**
+         * @brief Graphics pipelines are compiled asynchronously. Blocks until the pipeline is ready,
+         * use `is_pipeline_ready` to skip draws instead.
+        */
+        const vk::Pipeline& pipeline_from_handle(Graphics_pipeline_handle p) const { return m_graphics_pipelines.at(std::size_t(p)).pipeline.wait(); };
         vk::Pipeline& pipeline_from_handle(Compute_pipeline_handle p) { return m_compute_pipelines.at(std::size_t(p)).pipeline; };
-        const Window_win32_data& window_data() const { return m_window.window_data(); }
+        bool is_pipeline_ready(Graphics_pipeline_handle p) const { return m_graphics_pipelines.at(std::size_t(p)).pipeline.is_ready(); }
+        VkPipelineLayout pipeline_layout(Graphics_pipeline_handle p) const { return m_graphics_pipelines.at(std::size_t(p)).create_info.info.layout; }
+
+        /**
+         * @brief Returns the descriptor set layout of a pipeline whose layout was reflected from its shaders.
+        */
+        VkDescriptorSetLayout descriptor_set_layout(Graphics_pipeline_handle p, uint32_t set) const { return m_graphics_pipelines.at(std::size_t(p)).reflected_layout.value().set_layouts.at(set); }
+        uint32_t surface_width() const { return m_wsi->get_width(); }
+        uint32_t surface_height() const { return m_wsi->get_height(); }
+        bool is_headless() const { return m_headless; }
+        const vk::Spirv_cache_statistics& spirv_cache_statistics() const { return m_spirv_cache.statistics(); }
+
+        /**
+         * @brief The layout the swapchain image must be in after `swapchain_pass`.
+         * @details `VK_IMAGE_LAYOUT_PRESENT_SRC_KHR` if a swapchain is used,
+         * `VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL` when rendering offscreen.
+        */
+        VkImageLayout present_layout() const;
 
         vk::Descriptor_buffer_info descriptor_buffer_info(Buffer_handle buffer, VkDeviceSize offset, VkDeviceSize size);
 
@@ -135,24 +245,34 @@ namespace ygg::mini_sample
         void add_initial_upload(const Image_upload& image_upload);
 
     private:
-        void upload_data(vk::Graphics_command_buffer& cmdbuf);
+        void upload_data(vk::Graphics_command_buffer& cmdbuf, std::vector<vk::Semaphore_signal_info>& await_sema_infos);
+        void reload_shaders();
+        bool is_reflected_layout_unchanged(const detail::Graphics_pipeline& pipeline,
+            const detail::Graphics_pipeline_reload& reload);
+        void swap_reloaded_pipeline(detail::Graphics_pipeline& pipeline);
         void frame_loop();
+        bool is_running(uint32_t frame_count) const;
         vk::Allocated_buffer select_allocated_buffer(Buffer_handle buf);
 
     private:
         util::Clock m_clock;
-        Window_win32 m_window;
-        vk::Window_system_integration_win32 m_wsi;
+        bool m_headless;
+        uint32_t m_headless_frame_count;
+        std::unique_ptr<Window_win32> m_window;
+        std::unique_ptr<vk::Window_system_integration> m_wsi;
         vk::Context m_context;
-        vk::Swapchain m_swapchain;
-
-        std::vector<Buffer_upload> m_buffer_uploads = {};
-        std::vector<Image_upload> m_image_uploads = {};
+        vk::glsl_compiler::Batch_compiler m_shader_compiler;
+        vk::Spirv_cache m_spirv_cache;
+        std::unique_ptr<util::File_watcher> m_shader_watcher;
+        std::unique_ptr<vk::Swapchain> m_swapchain;
+        std::unique_ptr<vk::Offscreen_swapchain> m_offscreen_swapchain;
+        std::unique_ptr<vk::Upload_service> m_upload_service;
 
         std::vector<vk::Buffer> m_buffers = {};
         std::vector<vk::Image> m_images = {};
         std::vector<VkDescriptorSetLayout> m_set_layouts = {};
         std::vector<VkPipelineLayout> m_pipeline_layouts = {};
+        std::vector<VkDescriptorUpdateTemplate> m_descriptor_update_templates = {};
         std::vector<detail::Graphics_pipeline> m_graphics_pipelines = {};
         std::vector<detail::Compute_pipeline> m_compute_pipelines = {};
     };
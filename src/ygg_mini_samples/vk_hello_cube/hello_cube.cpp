@@ -5,6 +5,9 @@
 #include <volk.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
 
 using namespace ygg;
 using namespace ygg::mini_sample;
@@ -45,43 +48,10 @@ public:
         };
         m_depth_attachment = create_managed_image(depth_attachment_info);
 
-        vk::Descriptor_set_layout_info set_layout_info = {
-            .flags = 0,
-            .bindings = {
-                /**
-                 * Instead of utilizing the fixed function vertex pipeline,
-                 * we will use vertex pulling in this example.
-                */
-                {
-                    .binding = 0,
-                    .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                    .count = 1,
-                    .stages = VK_SHADER_STAGE_VERTEX_BIT,
-                    .immutable_samplers = {},
-                    .flags = 0
-                },
-                /**
-                 * Uniform binding for rotation and projection.
-                */
-                {
-                    .binding = 1,
-                    .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                    .count = 1,
-                    .stages = VK_SHADER_STAGE_VERTEX_BIT,
-                    .immutable_samplers = {},
-                    .flags = 0
-                }
-            }
-        };
-        m_descriptor_layout = create_managed_descriptor_set_layout(set_layout_info);
-
-        auto set_layout_arr = std::to_array<VkDescriptorSetLayout>({ m_descriptor_layout });
-        vk::Pipeline_layout_info pipe_layout_info = {
-            .layouts = set_layout_arr,
-            .push_constant_ranges = {}
-        };
-        m_pipeline_layout = create_managed_pipeline_layout(pipe_layout_info);
-
+        /**
+         * Instead of utilizing the fixed function vertex pipeline, we will use vertex pulling in this example.
+         * The descriptor set and pipeline layouts are reflected from the shaders.
+        */
         Graphics_pipeline_create_info pipe_info = {
             .paths = {
                 .vert = "res/shader/mini_sample/hello_cube/cube.vert",
@@ -116,11 +86,33 @@ public:
                         .blend_enable = false,
                         .format = VK_FORMAT_R8G8B8A8_SRGB
                     }
-                },
-                .layout = m_pipeline_layout
+                }
             }
         };
         m_graphics_pipeline = create_managed_graphics_pipeline(pipe_info);
+        m_descriptor_layout = descriptor_set_layout(m_graphics_pipeline, 0);
+        m_pipeline_layout = pipeline_layout(m_graphics_pipeline);
+        m_descriptor_template = create_managed_descriptor_update_template({
+            .layout = m_descriptor_layout,
+            .entries = {
+                {
+                    .binding = 0,
+                    .array_index = 0,
+                    .count = 1,
+                    .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .offset = offsetof(Cube_descriptors, vertices),
+                    .stride = sizeof(vk::Descriptor_buffer_info)
+                },
+                {
+                    .binding = 1,
+                    .array_index = 0,
+                    .count = 1,
+                    .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                    .offset = offsetof(Cube_descriptors, uniforms),
+                    .stride = sizeof(vk::Descriptor_buffer_info)
+                }
+            }
+            });
 
         struct Vertex
         {
@@ -202,27 +194,11 @@ public:
             .flush(0);
 
         auto set = frame_ctx.allocate_transient_descriptor_set(m_descriptor_layout);
-        vk::Descriptor_buffer_info vert_desc_buf_info = descriptor_buffer_info(m_cube_buffer, 0, VK_WHOLE_SIZE);
-        auto vert_desc_buf_info_arr = std::to_array<vk::Descriptor_buffer_info>({ vert_desc_buf_info });
-        vk::Descriptor_buffer_info uniform_desc_buf_info = descriptor_buffer_info(m_uniform_buffer, 0, VK_WHOLE_SIZE);
-        auto uniform_desc_buf_info_arr = std::to_array<vk::Descriptor_buffer_info>({ uniform_desc_buf_info });
-        auto desc_updates = std::to_array<vk::Descriptor_set_write_info>({
-            {
-                .set = set,
-                .binding = 0,
-                .array_index = 0,
-                .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                .buffer_infos = { vert_desc_buf_info_arr }
-            },
-            {
-                .set = set,
-                .binding = 1,
-                .array_index = 0,
-                .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                .buffer_infos = { uniform_desc_buf_info_arr }
-            }
-            });
-        update_descriptor_sets(desc_updates);
+        Cube_descriptors descriptors = {
+            .vertices = descriptor_buffer_info(m_cube_buffer, 0, VK_WHOLE_SIZE),
+            .uniforms = descriptor_buffer_info(m_uniform_buffer, 0, VK_WHOLE_SIZE)
+        };
+        update_descriptor_set_with_template(set, m_descriptor_template, &descriptors);
 
         auto color_attachments = std::to_array<vk::Rendering_info::Attachment_info>({
             {
@@ -261,10 +237,9 @@ public:
             }}
         };
 
-        const auto& w_data = window_data();
         glm::mat4 proj = glm::perspective(
             glm::radians(60.0f),
-            float_t(w_data.width) / float_t(w_data.height),
+            float_t(surface_width()) / float_t(surface_height()),
             0.05f,
             10.0f);
         glm::mat4 view = glm::lookAt(
@@ -285,12 +260,15 @@ public:
         cmdbuf.begin_rendering(ri);
         cmdbuf.set_viewport(0.0f, float_t(WINDOW_HEIGHT), float_t(WINDOW_WIDTH), -float_t(WINDOW_HEIGHT));
         cmdbuf.set_scissor(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
-        auto& pipeline = pipeline_from_handle(m_graphics_pipeline);
-        cmdbuf.bind_descriptor_set(pipeline.bind_point, m_pipeline_layout, 0, set);
-        cmdbuf.bind_pipeline(pipeline);
-        auto& cube_index_buffer = buf_from_handle(m_cube_index_buffer);
-        cmdbuf.bind_index_buffer(cube_index_buffer, 0, VK_INDEX_TYPE_UINT16);
-        cmdbuf.draw_indexed(36);
+        // The pipeline compiles in the background, the cube is skipped until it is ready.
+        if (is_pipeline_ready(m_graphics_pipeline)) {
+            auto& pipeline = pipeline_from_handle(m_graphics_pipeline);
+            cmdbuf.bind_descriptor_set(pipeline.bind_point, m_pipeline_layout, 0, set);
+            cmdbuf.bind_pipeline(pipeline);
+            auto& cube_index_buffer = buf_from_handle(m_cube_index_buffer);
+            cmdbuf.bind_index_buffer(cube_index_buffer, 0, VK_INDEX_TYPE_UINT16);
+            cmdbuf.draw_indexed(36);
+        }
         cmdbuf.end_rendering();
     }
 
@@ -334,27 +312,58 @@ public:
 
         cmdbuf.pipeline_barrier_builder()
             .push_image_memory_barrier(
+                VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_MEMORY_WRITE_BIT,
                 VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE,
-                VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE,
-                VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, present_layout(),
                 swapchain_img.allocated_image.handle, vk::img_utils::get_image_subresource_range(VK_IMAGE_ASPECT_COLOR_BIT))
             .flush(0);
     }
 
 private:
+    struct Cube_descriptors
+    {
+        vk::Descriptor_buffer_info vertices;
+        vk::Descriptor_buffer_info uniforms;
+    };
+
     Image_handle m_color_attachment;
     Image_handle m_depth_attachment;
     VkDescriptorSetLayout m_descriptor_layout;
     VkPipelineLayout m_pipeline_layout;
+    VkDescriptorUpdateTemplate m_descriptor_template;
     Graphics_pipeline_handle m_graphics_pipeline;
     Buffer_handle m_cube_buffer;
     Buffer_handle m_cube_index_buffer;
     Buffer_handle m_uniform_buffer;
 };
 
-int32_t main(uint32_t, char*[])
+int32_t main(uint32_t argc, char* argv[])
 {
-    App app(WINDOW_WIDTH, WINDOW_HEIGHT, "Hello Vulkan Cube!");
+    Base_app_info app_info = {
+        .window_width = WINDOW_WIDTH,
+        .window_height = WINDOW_HEIGHT,
+        .title = "Hello Vulkan Cube!",
+        .spirv_cache_directory = "spirv_cache",
+        .shader_hot_reload = true
+    };
+    // `--headless <frames>` runs the sample without a window for the given amount of frames.
+    // `--frames-in-flight <count>` sets the amount of frames in flight.
+    // `--low-latency` waits for the previous frame before sampling input.
+    for (uint32_t i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--low-latency") == 0) {
+            app_info.low_latency = true;
+        }
+        if (i + 1 >= argc) {
+            continue;
+        }
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            app_info.headless_frame_count = uint32_t(std::strtoul(argv[i + 1], nullptr, 10));
+        }
+        if (std::strcmp(argv[i], "--frames-in-flight") == 0) {
+            app_info.max_frames_in_flight = uint32_t(std::strtoul(argv[i + 1], nullptr, 10));
+        }
+    }
+    App app(app_info);
     app.run();
     return 0;
 }
@@ -35,5 +35,13 @@ macro(ygg_configure_project_msvc TARGET)
         target_compile_definitions(${TARGET} PRIVATE
         "$<$<CONFIG:Release>:YGG_VULKAN_VALIDATION=0; YGG_DEBUG=0; YGG_VULKAN_NAMES=0>")
         set_target_properties(${TARGET} PROPERTIES VS_DEBUGGER_WORKING_DIRECTORY "${CMAKE_SOURCE_DIR}")
+    else()
+        target_compile_features(${TARGET} PRIVATE cxx_std_20)
+        target_compile_definitions(${TARGET} PRIVATE
+        "$<$<CONFIG:Debug>:YGG_VULKAN_VALIDATION=1;YGG_DEBUG=1;YGG_VULKAN_NAMES=1>")
+        target_compile_definitions(${TARGET} PRIVATE
+        "$<$<CONFIG:RelWithDebInfo>:YGG_VULKAN_VALIDATION=1;YGG_DEBUG=0;YGG_VULKAN_NAMES=1>")
+        target_compile_definitions(${TARGET} PRIVATE
+        "$<$<CONFIG:Release>:YGG_VULKAN_VALIDATION=0;YGG_DEBUG=0;YGG_VULKAN_NAMES=0>")
     endif()
 endmacro()